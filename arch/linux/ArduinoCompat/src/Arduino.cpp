@@ -0,0 +1,177 @@
+#include "Arduino.h"
+
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sched.h>
+
+static struct timespec start_time;
+static bool start_time_set = false;
+
+static unsigned long elapsedMicros() {
+  if (!start_time_set) {
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    start_time_set = true;
+  }
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long)(now.tv_sec - start_time.tv_sec) * 1000000UL + (now.tv_nsec - start_time.tv_nsec) / 1000;
+}
+
+static unsigned long (*millis_source)() = NULL;
+
+void setMillisSource(unsigned long (*source)()) {
+  millis_source = source;
+}
+
+unsigned long millis() {
+  if (millis_source) return millis_source();
+  return elapsedMicros() / 1000;
+}
+
+unsigned long micros() {
+  if (millis_source) return millis_source() * 1000;
+  return elapsedMicros();
+}
+
+void delay(unsigned long ms) {
+  if (millis_source) return;   // virtual time, nothing to wait for
+  usleep(ms * 1000);
+}
+
+void yield() {
+  sched_yield();
+}
+
+static uint32_t rand_state = 1;
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) rand_state = (uint32_t) seed;
+}
+
+static uint32_t nextRand() {   // xorshift32, matches the 'cheap PRNG' nature of the Arduino impls
+  uint32_t x = rand_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return rand_state = x;
+}
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  return nextRand() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+char* ltoa(long value, char* dest, int base) {
+  char tmp[sizeof(long)*8 + 2];
+  char* tp = tmp;
+  bool neg = value < 0 && base == 10;
+  unsigned long v = neg ? -value : (unsigned long) value;
+  do {
+    int d = v % base;
+    *tp++ = d < 10 ? '0' + d : 'a' + d - 10;
+    v /= base;
+  } while (v);
+
+  char* dp = dest;
+  if (neg) *dp++ = '-';
+  while (tp > tmp) *dp++ = *--tp;
+  *dp = 0;
+  return dest;
+}
+
+// ----------------- Print -----------------
+
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+  char buf[sizeof(unsigned long)*8 + 1];
+  char* sp = &buf[sizeof(buf) - 1];
+  *sp = 0;
+  if (base < 2) base = 10;
+  do {
+    char d = n % base;
+    *--sp = d < 10 ? d + '0' : d + 'A' - 10;
+    n /= base;
+  } while (n);
+  return write(sp);
+}
+
+size_t Print::print(long n, int base) {
+  if (base == 10 && n < 0) {
+    size_t t = print('-');
+    return t + printNumber(-n, 10);
+  }
+  return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+  if (len >= (int) sizeof(buf)) len = sizeof(buf) - 1;   // truncated
+  return write((const uint8_t *) buf, len);
+}
+
+// ----------------- Serial (console) -----------------
+
+ConsoleSerial Serial;
+
+int ConsoleSerial::available() {
+  if (_peeked >= 0) return 1;
+
+  struct pollfd pfd;
+  pfd.fd = STDIN_FILENO;
+  pfd.events = POLLIN;
+  return (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) ? 1 : 0;
+}
+
+int ConsoleSerial::read() {
+  if (_peeked >= 0) {
+    int c = _peeked;
+    _peeked = -1;
+    return c;
+  }
+  if (!available()) return -1;
+
+  uint8_t c;
+  if (::read(STDIN_FILENO, &c, 1) != 1) return -1;
+  static const bool is_terminal = isatty(STDIN_FILENO);
+  if (c == '\n' && is_terminal) return '\r';   // terminal sends LF, serial monitors send CR
+  return c;   // (binary frames, eg. companion protocol, are piped/socketed in, so must not be altered)
+}
+
+int ConsoleSerial::peek() {
+  if (_peeked < 0) _peeked = read();
+  return _peeked;
+}
+
+// NOTE: flushed straight away, like a UART, so that eg. a binary frame doesn't wait in stdio for an LF byte
+
+size_t ConsoleSerial::write(uint8_t c) {
+  size_t n = fwrite(&c, 1, 1, stdout);
+  fflush(stdout);
+  return n;
+}
+
+size_t ConsoleSerial::write(const uint8_t* buffer, size_t size) {
+  size_t n = fwrite(buffer, 1, size, stdout);
+  fflush(stdout);
+  return n;
+}
+
+void ConsoleSerial::flush() {
+  fflush(stdout);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// Minimal subset of the Arduino core API, so MeshCore (and the examples) can be built for a Linux host.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <type_traits>
+
+#include "Stream.h"
+
+// like the Arduino macros, these accept mixed argument types
+template<typename A, typename B> inline typename std::common_type<A, B>::type min(A a, B b) { return a < b ? a : b; }
+template<typename A, typename B> inline typename std::common_type<A, B>::type max(A a, B b) { return a > b ? a : b; }
+template<typename T, typename L, typename H> inline T constrain(T x, L lo, H hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define PROGMEM
+#define pgm_read_byte(addr)  (*(const uint8_t *)(addr))
+
+#define LOW     0
+#define HIGH    1
+#define INPUT   0
+#define OUTPUT  1
+#define INPUT_PULLUP  2
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+/**
+ * \brief  (non-Arduino) lets a harness (eg. a simulator) substitute its own virtual time for millis()/micros().
+ *         While a source is installed, delay() returns immediately. Pass NULL to revert to the host clock.
+ */
+void setMillisSource(unsigned long (*source)());
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+inline void pinMode(uint8_t pin, uint8_t mode) { }
+inline void digitalWrite(uint8_t pin, uint8_t val) { }
+inline int digitalRead(uint8_t pin) { return LOW; }
+inline int analogRead(uint8_t pin) { return 0; }
+
+char* ltoa(long value, char* dest, int base);
+
+/**
+ * \brief  Serial console, bound to the process' stdin/stdout.
+ */
+class ConsoleSerial : public Stream {
+  int _peeked;
+
+public:
+  ConsoleSerial() { _peeked = -1; }
+
+  void begin(unsigned long baud) { }
+  void end() { }
+  operator bool() const { return true; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  void flush() override;
+
+  using Print::write;
+};
+
+extern ConsoleSerial Serial;
+
+// supplied by the application (ie. examples/*/main.cpp)
+void setup();
+void loop();
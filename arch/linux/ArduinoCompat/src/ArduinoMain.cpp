@@ -0,0 +1,16 @@
+#include "Arduino.h"
+#include <unistd.h>
+
+// NOTE: kept in its own translation unit, so that host programs which supply their own main()
+//       (eg. the simulator) don't pull this in from the library archive.
+
+int main(int argc, char* argv[]) {
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  setup();
+  for (;;) {
+    loop();
+    usleep(1000);   // don't spin the CPU at 100%
+  }
+  return 0;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+  size_t printNumber(unsigned long n, uint8_t base);
+
+public:
+  virtual ~Print() { }
+
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size-- > 0) {
+      if (write(*buffer++)) n++; else break;
+    }
+    return n;
+  }
+  size_t write(const char* str) { return str ? write((const uint8_t *) str, strlen(str)) : 0; }
+  size_t write(const char* buffer, size_t size) { return write((const uint8_t *) buffer, size); }
+
+  virtual void flush() { }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(char c) { return write((uint8_t) c); }
+  size_t print(unsigned char n, int base = DEC) { return print((unsigned long) n, base); }
+  size_t print(int n, int base = DEC) { return print((long) n, base); }
+  size_t print(unsigned int n, int base = DEC) { return print((unsigned long) n, base); }
+  size_t print(long n, int base = DEC);
+  size_t print(unsigned long n, int base = DEC) { return printNumber(n, base); }
+  size_t print(double n, int digits = 2);
+
+  size_t println() { return write("\r\n"); }
+  template<typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+  template<typename T> size_t println(T v, int arg) { size_t n = print(v, arg); return n + println(); }
+
+  size_t printf(const char* format, ...) __attribute__ ((format (printf, 2, 3)));
+};
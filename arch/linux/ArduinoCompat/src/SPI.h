@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Arduino.h"
+
+#define SPI_MODE0  0
+#define MSBFIRST   1
+
+class SPISettings {
+public:
+  SPISettings() { }
+  SPISettings(uint32_t clock, uint8_t bit_order, uint8_t data_mode) { }
+};
+
+// No SPI bus on the host, transfers just read back zeroes.
+class SPIClass {
+public:
+  void begin() { }
+  void end() { }
+  void beginTransaction(SPISettings settings) { }
+  void endTransaction() { }
+  uint8_t transfer(uint8_t data) { return 0; }
+  void transfer(void* buf, size_t count) { memset(buf, 0, count); }
+};
+
+extern SPIClass SPI;
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Print.h"
+
+class Stream : public Print {
+protected:
+  unsigned long _timeout;
+
+public:
+  Stream() { _timeout = 1000; }
+
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { _timeout = timeout; }
+
+  /**
+   * \brief  reads up to 'length' bytes. NOTE: host streams never block waiting for data, so the
+   *         timeout only applies to sub-classes that override this.
+   */
+  virtual size_t readBytes(uint8_t* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length) {
+      int c = read();
+      if (c < 0) break;
+      buffer[n++] = (uint8_t) c;
+    }
+    return n;
+  }
+  size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t *) buffer, length); }
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Arduino.h"
+
+// No I2C bus on the host, so every transaction just fails (ie. no devices found).
+class TwoWire : public Stream {
+public:
+  bool begin() { return true; }
+  bool begin(int sda, int scl) { return true; }
+  void end() { }
+  void setClock(uint32_t freq) { }
+  void beginTransmission(uint8_t addr) { }
+  uint8_t endTransmission(bool stop = true) { return 2; }   // NACK on address
+  size_t requestFrom(uint8_t addr, size_t len, bool stop = true) { return 0; }
+
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t c) override { return 1; }
+  using Print::write;
+};
+
+extern TwoWire Wire;
@@ -16,6 +16,8 @@ DataStore::DataStore(FILESYSTEM& fs, mesh::RTCClock& clock) : _fs(&fs), _fsExtra
     identity_store(fs, "/identity")
 #endif
 {
+  _next_unique = _unique_limit = 0;
+  _unique_slot = 0;
 }
 
 #if defined(EXTRAFS) || defined(QSPIFLASH)
@@ -28,6 +30,8 @@ DataStore::DataStore(FILESYSTEM& fs, FILESYSTEM& fsExtra, mesh::RTCClock& clock)
     identity_store(fs, "/identity")
 #endif
 {
+  _next_unique = _unique_limit = 0;
+  _unique_slot = 0;
 }
 #endif
 
@@ -112,6 +116,8 @@ uint32_t DataStore::getStorageUsedKb() const {
   int usedBlockCount = _getLfsUsedBlockCount(_getContactsChannelsFS());
   int usedBytes = config->block_size * usedBlockCount;
   return usedBytes / 1024;
+#elif defined(LINUX_PLATFORM)
+  return _fs->usedBytes() / 1024;
 #else
   return 0;
 #endif
@@ -129,6 +135,8 @@ uint32_t DataStore::getStorageTotalKb() const {
   const lfs_config* config = _getContactsChannelsFS()->_getFS()->cfg;
   int totalBytes = config->block_size * config->block_count;
   return totalBytes / 1024;
+#elif defined(LINUX_PLATFORM)
+  return _fs->totalBytes() / 1024;
 #else
   return 0;
 #endif
@@ -154,6 +162,49 @@ File DataStore::openRead(FILESYSTEM* fs, const char* filename) {
 #endif
 }
 
+File DataStore::openAppend(FILESYSTEM* fs, const char* filename) {
+#if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
+  return fs->open(filename, FILE_O_WRITE);   // creates, or positions at end
+#elif defined(RP2040_PLATFORM)
+  return fs->open(filename, "a");
+#else
+  return fs->open(filename, "a", true);
+#endif
+}
+
+#define UNIQUE_NUM_BLOCK   32   // numbers reserved per flash write
+
+static const char* unique_num_files[2] = { "/unique_a", "/unique_b" };   // written alternately, so a power loss mid write still leaves the other
+
+uint32_t DataStore::nextUniqueNum() {
+  if (_next_unique == _unique_limit) {   // reserve another block
+    if (_unique_limit == 0) {   // first time since boot, carry on from highest saved limit
+      for (int i = 0; i < 2; i++) {
+        uint32_t limit = 0;
+        File file = openRead(_fs, unique_num_files[i]);
+        if (file) {
+          if (file.read((uint8_t *) &limit, sizeof(limit)) != sizeof(limit)) limit = 0;
+          file.close();
+        }
+        if (limit > _unique_limit) {
+          _unique_limit = limit;
+          _unique_slot = i ^ 1;   // overwrite the older one
+        }
+      }
+      _next_unique = _unique_limit;
+    }
+    uint32_t limit = _next_unique + UNIQUE_NUM_BLOCK;
+    File file = openWrite(_fs, unique_num_files[_unique_slot]);
+    bool ok = file && file.write((uint8_t *) &limit, sizeof(limit)) == sizeof(limit);
+    if (file) file.close();
+    if (!ok) return 0;
+
+    _unique_limit = limit;   // (numbers up to here are now safe to hand out)
+    _unique_slot ^= 1;
+  }
+  return ++_next_unique;
+}
+
 bool DataStore::removeFile(const char* filename) {
   return _fs->remove(filename);
 }
@@ -162,6 +213,10 @@ bool DataStore::removeFile(FILESYSTEM* fs, const char* filename) {
   return fs->remove(filename);
 }
 
+bool DataStore::renameFile(FILESYSTEM* fs, const char* from, const char* to) {
+  return fs->rename(from, to);
+}
+
 bool DataStore::formatFileSystem() {
 #if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
   if (_fsExtra == nullptr) {
@@ -173,6 +228,8 @@ bool DataStore::formatFileSystem() {
   return LittleFS.format();
 #elif defined(ESP32)
   return ((fs::SPIFFSFS *)_fs)->format();
+#elif defined(LINUX_PLATFORM)
+  return _fs->format();
 #else
   #error "need to implement format()"
 #endif
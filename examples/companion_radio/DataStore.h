@@ -18,6 +18,8 @@ class DataStore {
   FILESYSTEM* _fsExtra;
   mesh::RTCClock* _clock;
   IdentityStore identity_store;
+  uint32_t _next_unique, _unique_limit;   // see nextUniqueNum()
+  int _unique_slot;
 
   void loadPrefsInt(const char *filename, NodePrefs& prefs, double& node_lat, double& node_lon);
 #if defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)
@@ -44,8 +46,15 @@ public:
   bool putBlobByKey(const uint8_t key[], int key_len, const uint8_t src_buf[], uint8_t len);
   File openRead(const char* filename);
   File openRead(FILESYSTEM* fs, const char* filename);
+  File openAppend(FILESYSTEM* fs, const char* filename);
   bool removeFile(const char* filename);
   bool removeFile(FILESYSTEM* fs, const char* filename);
+  bool renameFile(FILESYSTEM* fs, const char* from, const char* to);
+  /**
+   * \returns  a number never returned before, even across reboots, or 0 if that can't be saved. (saved in blocks,
+   *           so most calls don't write to flash)
+   */
+  uint32_t nextUniqueNum();
   uint32_t getStorageUsedKb() const;
   uint32_t getStorageTotalKb() const;
 
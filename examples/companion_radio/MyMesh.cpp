@@ -50,6 +50,10 @@
 #define CMD_SEND_BINARY_REQ           50
 #define CMD_FACTORY_RESET             51
 #define CMD_SEND_PATH_DISCOVERY_REQ   52
+#define CMD_GET_LATENCY_STATS         53
+#define CMD_SYNC_MESSAGES             54   // {credits}, v8+: stream up to 'credits' more messages
+#define CMD_GET_SERIAL_STATS          55
+#define CMD_SET_PUSH_MASK             56   // {mask(4)}, bit N = push code 0x80+N, for the app sending this
 
 #define RESP_CODE_OK                  0
 #define RESP_CODE_ERR                 1
@@ -61,7 +65,7 @@
 #define RESP_CODE_CONTACT_MSG_RECV    7  // a reply to CMD_SYNC_NEXT_MESSAGE (ver < 3)
 #define RESP_CODE_CHANNEL_MSG_RECV    8  // a reply to CMD_SYNC_NEXT_MESSAGE (ver < 3)
 #define RESP_CODE_CURR_TIME           9  // a reply to CMD_GET_DEVICE_TIME
-#define RESP_CODE_NO_MORE_MESSAGES    10 // a reply to CMD_SYNC_NEXT_MESSAGE
+#define RESP_CODE_NO_MORE_MESSAGES    10 // a reply to CMD_SYNC_NEXT_MESSAGE, or end of CMD_SYNC_MESSAGES stream
 #define RESP_CODE_EXPORT_CONTACT      11
 #define RESP_CODE_BATT_AND_STORAGE    12 // a reply to a CMD_GET_BATT_AND_STORAGE
 #define RESP_CODE_DEVICE_INFO         13 // a reply to CMD_DEVICE_QEURY
@@ -75,12 +79,16 @@
 #define RESP_CODE_CUSTOM_VARS         21
 #define RESP_CODE_ADVERT_PATH         22
 #define RESP_CODE_TUNING_PARAMS       23
+#define RESP_CODE_LATENCY_STATS       24 // a reply to CMD_GET_LATENCY_STATS
+#define RESP_CODE_CONTACTS_BATCH      25 // multiple of these (after CMD_GET_CONTACTS, ver >= 8), each with 1+ contacts
+#define RESP_CODE_SERIAL_STATS        26 // a reply to CMD_GET_SERIAL_STATS
 
 #define SEND_TIMEOUT_BASE_MILLIS        500
 #define FLOOD_SEND_TIMEOUT_FACTOR       16.0f
 #define DIRECT_SEND_PERHOP_FACTOR       6.0f
 #define DIRECT_SEND_PERHOP_EXTRA_MILLIS 250
 #define LAZY_CONTACTS_WRITE_DELAY       5000
+#define OFFLINE_FLUSH_RETRY_DELAY       60000
 
 #define PUBLIC_GROUP_PSK                "izOH6cXN6mrJ5e26oRXNcg=="
 
@@ -107,7 +115,9 @@
 #define ERR_CODE_FILE_IO_ERROR          5
 #define ERR_CODE_ILLEGAL_ARG            6
 
-#define MAX_SIGN_DATA_LEN               (8 * 1024) // 8K
+#ifndef MAX_SIGN_DATA_LEN
+  #define MAX_SIGN_DATA_LEN             (64 * 1024) // 64K  (signed incrementally, so not held in RAM)
+#endif
 
 void MyMesh::writeOKFrame() {
   uint8_t buf[1];
@@ -150,6 +160,46 @@ void MyMesh::writeContactRespFrame(uint8_t code, const ContactInfo &contact) {
   _serial->writeFrame(out_frame, i);
 }
 
+/*
+ * Compact form of a contact, for RESP_CODE_CONTACTS_BATCH:
+ *   rec_len(1), pub_key(32), type(1), flags(1), out_path_len(1), out_path(out_path_len, if > 0),
+ *   last_advert_timestamp(4), lastmod(4), name(null terminated), [gps_lat(4), gps_lon(4)  -- only if not both zero]
+ * rec_len is the number of bytes that follow it, so that apps can skip any fields added in future.
+ * At most 148 bytes, so always fits in an otherwise empty frame. Returns the length, or 0 if it won't fit in max_len.
+ */
+int MyMesh::writeContactRecord(uint8_t* dest, int max_len, const ContactInfo &contact) {
+  int path_len = contact.out_path_len > 0 ? contact.out_path_len : 0;
+  int name_len = strlen(contact.name);
+  if (name_len > (int)sizeof(contact.name) - 1) name_len = sizeof(contact.name) - 1;
+  bool has_gps = contact.gps_lat != 0 || contact.gps_lon != 0;
+  int len = 1 + PUB_KEY_SIZE + 3 + path_len + 8 + name_len + 1 + (has_gps ? 8 : 0);
+  if (len > max_len) return 0;
+
+  int i = 0;
+  dest[i++] = len - 1;
+  memcpy(&dest[i], contact.id.pub_key, PUB_KEY_SIZE);
+  i += PUB_KEY_SIZE;
+  dest[i++] = contact.type;
+  dest[i++] = contact.flags;
+  dest[i++] = contact.out_path_len;
+  memcpy(&dest[i], contact.out_path, path_len);
+  i += path_len;
+  memcpy(&dest[i], &contact.last_advert_timestamp, 4);
+  i += 4;
+  memcpy(&dest[i], &contact.lastmod, 4);
+  i += 4;
+  memcpy(&dest[i], contact.name, name_len);
+  i += name_len;
+  dest[i++] = 0;
+  if (has_gps) {
+    memcpy(&dest[i], &contact.gps_lat, 4);
+    i += 4;
+    memcpy(&dest[i], &contact.gps_lon, 4);
+    i += 4;
+  }
+  return i;
+}
+
 void MyMesh::updateContactFromFrame(ContactInfo &contact, uint32_t& last_mod, const uint8_t *frame, int len) {
   int i = 0;
   uint8_t code = frame[i++]; // eg. CMD_ADD_UPDATE_CONTACT
@@ -175,46 +225,13 @@ void MyMesh::updateContactFromFrame(ContactInfo &contact, uint32_t& last_mod, co
   }
 }
 
-bool MyMesh::Frame::isChannelMsg() const {
-  return buf[0] == RESP_CODE_CHANNEL_MSG_RECV || buf[0] == RESP_CODE_CHANNEL_MSG_RECV_V3;
-}
-
 void MyMesh::addToOfflineQueue(const uint8_t frame[], int len) {
-  if (offline_queue_len >= OFFLINE_QUEUE_SIZE) {
-    MESH_DEBUG_PRINTLN("WARN: offline_queue is full!");
-    int pos = 0;
-    while (pos < offline_queue_len) {
-      if (offline_queue[pos].isChannelMsg()) {
-        for (int i = pos; i < offline_queue_len - 1; i++) { // delete oldest channel msg from queue
-          offline_queue[i] = offline_queue[i + 1];
-        }
-        MESH_DEBUG_PRINTLN("INFO: removed oldest channel message from queue.");
-        offline_queue[offline_queue_len - 1].len = len;
-        memcpy(offline_queue[offline_queue_len - 1].buf, frame, len);
-        return;
-      }
-      pos++;
-    }
-    MESH_DEBUG_PRINTLN("INFO: no channel messages to remove from queue.");
-  } else {
-    offline_queue[offline_queue_len].len = len;
-    memcpy(offline_queue[offline_queue_len].buf, frame, len);
-    offline_queue_len++;
-  }
+  bool is_channel = frame[0] == RESP_CODE_CHANNEL_MSG_RECV || frame[0] == RESP_CODE_CHANNEL_MSG_RECV_V3;
+  offline_queue.add(frame, len, is_channel, !_serial->isConnected());   // straight to flash if no app to take it
 }
 
 int MyMesh::getFromOfflineQueue(uint8_t frame[]) {
-  if (offline_queue_len > 0) {         // check offline queue
-    size_t len = offline_queue[0].len; // take from top of queue
-    memcpy(frame, offline_queue[0].buf, len);
-
-    offline_queue_len--;
-    for (int i = 0; i < offline_queue_len; i++) { // delete top item from queue
-      offline_queue[i] = offline_queue[i + 1];
-    }
-    return len;
-  }
-  return 0; // queue is empty
+  return offline_queue.get(frame);
 }
 
 float MyMesh::getAirtimeBudgetFactor() const {
@@ -236,14 +253,14 @@ uint8_t MyMesh::getExtraAckTransmitCount() const {
 
 void MyMesh::logRxRaw(float snr, float rssi, const uint8_t raw[], int len) {
   if (_serial->isConnected() && len + 3 <= MAX_FRAME_SIZE) {
-    int i = 0;
-    out_frame[i++] = PUSH_CODE_LOG_RX_DATA;
-    out_frame[i++] = (int8_t)(snr * 4);
-    out_frame[i++] = (int8_t)(rssi);
-    memcpy(&out_frame[i], raw, len);
-    i += len;
-
-    _serial->writeFrame(out_frame, i);
+    uint8_t hdr[3];
+    hdr[0] = PUSH_CODE_LOG_RX_DATA;
+    hdr[1] = (int8_t)(snr * 4);
+    hdr[2] = (int8_t)(rssi);
+
+    const uint8_t* parts[2] = { hdr, raw };
+    size_t lens[2] = { sizeof(hdr), (size_t)len };
+    _serial->writeFrameParts(parts, lens, 2);
   }
 }
 
@@ -370,7 +387,7 @@ void MyMesh::queueMessage(const ContactInfo &from, uint8_t txt_type, mesh::Packe
   // we only want to show text messages on display, not cli data
   bool should_display = txt_type == TXT_TYPE_PLAIN || txt_type == TXT_TYPE_SIGNED_PLAIN;
   if (should_display && _ui) {
-    _ui->newMsg(path_len, from.name, text, offline_queue_len);
+    _ui->newMsg(path_len, from.name, text, offline_queue.count());
     if (!_serial->isConnected()) {
       _ui->notify(UIEventType::contactMessage);
     }
@@ -441,7 +458,7 @@ void MyMesh::onChannelMessageRecv(const mesh::GroupChannel &channel, mesh::Packe
   if (getChannel(channel_idx, channel_details)) {
     channel_name = channel_details.name;
   }
-  if (_ui) _ui->newMsg(path_len, channel_name, text, offline_queue_len);
+  if (_ui) _ui->newMsg(path_len, channel_name, text, offline_queue.count());
 #endif
 }
 
@@ -535,9 +552,10 @@ void MyMesh::onContactResponse(const ContactInfo &contact, const uint8_t *data,
     out_frame[i++] = 0; // reserved
     memcpy(&out_frame[i], contact.id.pub_key, 6);
     i += 6; // pub_key_prefix
-    memcpy(&out_frame[i], &data[4], len - 4);
-    i += (len - 4);
-    _serial->writeFrame(out_frame, i);
+
+    const uint8_t* parts[2] = { out_frame, &data[4] };   // header, then response as-is
+    size_t lens[2] = { (size_t)i, (size_t)(len - 4) };
+    _serial->writeFrameParts(parts, lens, 2);
   } else if (len > 4 && tag == pending_telemetry) {  // check for matching response tag
     pending_telemetry = 0;
 
@@ -546,9 +564,10 @@ void MyMesh::onContactResponse(const ContactInfo &contact, const uint8_t *data,
     out_frame[i++] = 0; // reserved
     memcpy(&out_frame[i], contact.id.pub_key, 6);
     i += 6; // pub_key_prefix
-    memcpy(&out_frame[i], &data[4], len - 4);
-    i += (len - 4);
-    _serial->writeFrame(out_frame, i);
+
+    const uint8_t* parts[2] = { out_frame, &data[4] };   // header, then response as-is
+    size_t lens[2] = { (size_t)i, (size_t)(len - 4) };
+    _serial->writeFrameParts(parts, lens, 2);
   } else if (len > 4 && tag == pending_req) {  // check for matching response tag
     pending_req = 0;
 
@@ -557,9 +576,10 @@ void MyMesh::onContactResponse(const ContactInfo &contact, const uint8_t *data,
     out_frame[i++] = 0; // reserved
     memcpy(&out_frame[i], &tag, 4);   // app needs to match this to RESP_CODE_SENT.tag
     i += 4;
-    memcpy(&out_frame[i], &data[4], len - 4);
-    i += (len - 4);
-    _serial->writeFrame(out_frame, i);
+
+    const uint8_t* parts[2] = { out_frame, &data[4] };
+    size_t lens[2] = { (size_t)i, (size_t)(len - 4) };
+    _serial->writeFrameParts(parts, lens, 2);
   }
 }
 
@@ -653,15 +673,17 @@ void MyMesh::onSendTimeout() {}
 
 MyMesh::MyMesh(mesh::Radio &radio, mesh::RNG &rng, mesh::RTCClock &rtc, SimpleMeshTables &tables, DataStore& store, AbstractUITask* ui)
     : BaseChatMesh(radio, *new ArduinoMillis(), rng, rtc, *new StaticPoolPacketManager(16), tables),
-      _serial(NULL), telemetry(MAX_PACKET_PAYLOAD - 4), _store(&store), _ui(ui) {
+      _serial(NULL), telemetry(MAX_PACKET_PAYLOAD - 4), _store(&store), _ui(ui), offline_queue(store, rtc) {
   _iter_started = false;
+  _sync_credits = 0;
+  _iter_session = _sync_session = 0;
   _cli_rescue = false;
-  offline_queue_len = 0;
   app_target_ver = 0;
   clearPendingReqs();
   next_ack_idx = 0;
-  sign_data = NULL;
+  sign_active = false;
   dirty_contacts_expiry = 0;
+  offline_flush_retry = 0;
   memset(advert_paths, 0, sizeof(advert_paths));
 
   // defaults
@@ -734,6 +756,7 @@ void MyMesh::begin(bool has_display) {
   _store->loadContacts(this);
   addChannel("Public", PUBLIC_GROUP_PSK); // pre-configure Andy's public channel
   _store->loadChannels(this);
+  offline_queue.begin();
 
   radio_set_params(_prefs.freq, _prefs.bw, _prefs.sf, _prefs.cr);
   radio_set_tx_power(_prefs.tx_power_dbm);
@@ -761,7 +784,7 @@ void MyMesh::handleCmdFrame(size_t len) {
     int i = 0;
     out_frame[i++] = RESP_CODE_DEVICE_INFO;
     out_frame[i++] = FIRMWARE_VER_CODE;
-    out_frame[i++] = MAX_CONTACTS / 2;   // v3+
+    out_frame[i++] = MAX_CONTACTS / 2 > 255 ? 255 : MAX_CONTACTS / 2;   // v3+ (one byte, so capped)
     out_frame[i++] = MAX_GROUP_CHANNELS; // v3+
     memcpy(&out_frame[i], &_prefs.ble_pin, 4);
     i += 4;
@@ -780,7 +803,9 @@ void MyMesh::handleCmdFrame(size_t len) {
     cmd_frame[len] = 0; // make app_name null terminated
     MESH_DEBUG_PRINTLN("App %s connected", app_name);
 
-    _iter_started = false; // stop any left-over ContactsIterator
+    uint32_t session = _serial->getReplySession();
+    if (_iter_session == session) _iter_started = false; // stop any left-over ContactsIterator
+    if (_sync_session == session) _sync_credits = 0;     // and message stream  (but not other apps')
     int i = 0;
     out_frame[i++] = RESP_CODE_SELF_INFO;
     out_frame[i++] = ADV_TYPE_CHAT; // what this node Advert identifies as (maybe node's pronouns too?? :-)
@@ -899,6 +924,7 @@ void MyMesh::handleCmdFrame(size_t len) {
       // start iterator
       _iter = startContactsIterator();
       _iter_started = true;
+      _iter_session = _serial->getReplySession();
       _most_recent_lastmod = 0;
     }
   } else if (cmd_frame[0] == CMD_SET_ADVERT_NAME && len >= 2) {
@@ -1058,12 +1084,25 @@ void MyMesh::handleCmdFrame(size_t len) {
     if ((out_len = getFromOfflineQueue(out_frame)) > 0) {
       _serial->writeFrame(out_frame, out_len);
 #ifdef DISPLAY_CLASS
-      if (_ui) _ui->msgRead(offline_queue_len);
+      if (_ui) _ui->msgRead(offline_queue.count());
 #endif
     } else {
       out_frame[0] = RESP_CODE_NO_MORE_MESSAGES;
       _serial->writeFrame(out_frame, 1);
     }
+  } else if (cmd_frame[0] == CMD_SYNC_MESSAGES && len >= 2) {
+    // app grants more credits, ie. how many more messages it can take. Messages are then streamed from
+    // checkSerialInterface(), as fast as the transport allows, until credits or queue run out. 0 = stop.
+    uint32_t session = _serial->getReplySession();
+    if (_sync_credits > 0 && _sync_session != session) {
+      writeErrFrame(ERR_CODE_BAD_STATE);   // another app is syncing
+    } else if (cmd_frame[1] == 0) {
+      _sync_credits = 0;
+    } else {
+      int credits = _sync_credits + cmd_frame[1];
+      _sync_credits = credits > 255 ? 255 : credits;
+      _sync_session = session;
+    }
   } else if (cmd_frame[0] == CMD_SET_RADIO_PARAMS) {
     int i = 1;
     uint32_t freq;
@@ -1120,6 +1159,47 @@ void MyMesh::handleCmdFrame(size_t len) {
     memcpy(&out_frame[i], &rx, 4); i += 4;
     memcpy(&out_frame[i], &af, 4); i += 4;
     _serial->writeFrame(out_frame, i);
+  } else if (cmd_frame[0] == CMD_GET_LATENCY_STATS && len >= 2) {   // {payload_type}
+    const mesh::LatencyStats* stats = getLatencyStats();
+    if (stats == NULL) {
+      writeDisabledFrame();
+    } else {
+      int i = 0;
+      out_frame[i++] = RESP_CODE_LATENCY_STATS;
+      out_frame[i++] = cmd_frame[1];
+      out_frame[i++] = LATENCY_NUM_STAGES;
+      for (int s = 0; s < LATENCY_NUM_STAGES; s++) {   // rxq, proc, txq, air, total
+        const mesh::LatencyHistogram& h = stats->get(cmd_frame[1], s);
+        memcpy(&out_frame[i], &h.count, 4); i += 4;
+        memcpy(&out_frame[i], &h.total_millis, 4); i += 4;
+        memcpy(&out_frame[i], &h.max_millis, 4); i += 4;
+        memcpy(&out_frame[i], h.buckets, sizeof(h.buckets)); i += sizeof(h.buckets);
+      }
+      _serial->writeFrame(out_frame, i);
+    }
+  } else if (cmd_frame[0] == CMD_GET_SERIAL_STATS) {
+    FrameQueueStats stats;
+    if (!_serial->getSendQueueStats(stats)) {
+      writeDisabledFrame();   // interface has no send queue
+    } else {
+      int i = 0;
+      out_frame[i++] = RESP_CODE_SERIAL_STATS;
+      memcpy(&out_frame[i], &stats.depth, 2); i += 2;
+      memcpy(&out_frame[i], &stats.max_depth, 2); i += 2;
+      memcpy(&out_frame[i], &stats.bytes_used, 2); i += 2;
+      memcpy(&out_frame[i], &stats.capacity, 2); i += 2;
+      memcpy(&out_frame[i], &stats.num_queued, 4); i += 4;
+      memcpy(&out_frame[i], &stats.num_dropped, 4); i += 4;
+      _serial->writeFrame(out_frame, i);
+    }
+  } else if (cmd_frame[0] == CMD_SET_PUSH_MASK && len >= 5) {
+    uint32_t mask;
+    memcpy(&mask, &cmd_frame[1], 4);
+    if (_serial->setPushMask(mask)) {
+      writeOKFrame();
+    } else {
+      writeDisabledFrame();   // interface only has the one app
+    }
   } else if (cmd_frame[0] == CMD_SET_OTHER_PARAMS) {
     _prefs.manual_add_contacts = cmd_frame[1];
     if (len >= 3) {
@@ -1140,6 +1220,7 @@ void MyMesh::handleCmdFrame(size_t len) {
     if (dirty_contacts_expiry) { // is there are pending dirty contacts write needed?
       saveContacts();
     }
+    offline_queue.flush();
     board.reboot();
   } else if (cmd_frame[0] == CMD_GET_BATT_AND_STORAGE) {
     uint8_t reply[11];
@@ -1362,31 +1443,35 @@ void MyMesh::handleCmdFrame(size_t len) {
       writeErrFrame(ERR_CODE_NOT_FOUND); // bad channel_idx
     }
   } else if (cmd_frame[0] == CMD_SIGN_START) {
-    out_frame[0] = RESP_CODE_SIGN_START;
-    out_frame[1] = 0; // reserved
-    uint32_t len = MAX_SIGN_DATA_LEN;
-    memcpy(&out_frame[2], &len, 4);
-    _serial->writeFrame(out_frame, 6);
-
-    if (sign_data) {
-      free(sign_data);
+    uint32_t uniq[2];
+    uniq[0] = _store->nextUniqueNum();   // for the nonce, as RNG can repeat after a reboot
+    uniq[1] = getRTCClock()->getCurrentTime();
+    if (uniq[0] == 0) {
+      writeErrFrame(ERR_CODE_FILE_IO_ERROR);   // can't be sure of a fresh nonce, so won't sign
+      sign_active = false;
+    } else {
+      out_frame[0] = RESP_CODE_SIGN_START;
+      out_frame[1] = 0; // reserved
+      uint32_t len = MAX_SIGN_DATA_LEN;
+      memcpy(&out_frame[2], &len, 4);
+      _serial->writeFrame(out_frame, 6);
+
+      self_id.signStart(sign_ctx, *getRNG(), (const uint8_t *) uniq, sizeof(uniq));   // (restarts, if one was in progress)
+      sign_active = true;
+      sign_data_len = 0;
     }
-    sign_data = (uint8_t *)malloc(MAX_SIGN_DATA_LEN);
-    sign_data_len = 0;
   } else if (cmd_frame[0] == CMD_SIGN_DATA && len > 1) {
-    if (sign_data == NULL || sign_data_len + (len - 1) > MAX_SIGN_DATA_LEN) {
-      writeErrFrame(sign_data == NULL ? ERR_CODE_BAD_STATE : ERR_CODE_TABLE_FULL); // error: too long
+    if (!sign_active || sign_data_len + (len - 1) > MAX_SIGN_DATA_LEN) {
+      writeErrFrame(!sign_active ? ERR_CODE_BAD_STATE : ERR_CODE_TABLE_FULL); // error: too long
     } else {
-      memcpy(&sign_data[sign_data_len], &cmd_frame[1], len - 1);
+      self_id.signUpdate(sign_ctx, &cmd_frame[1], len - 1);
       sign_data_len += (len - 1);
       writeOKFrame();
     }
   } else if (cmd_frame[0] == CMD_SIGN_FINISH) {
-    if (sign_data) {
-      self_id.sign(&out_frame[1], sign_data, sign_data_len);
-
-      free(sign_data); // don't need sign_data now
-      sign_data = NULL;
+    if (sign_active) {
+      self_id.signFinish(sign_ctx, &out_frame[1]);
+      sign_active = false;
 
       out_frame[0] = RESP_CODE_SIGNATURE;
       _serial->writeFrame(out_frame, 1 + SIGNATURE_SIZE);
@@ -1676,21 +1761,69 @@ void MyMesh::checkSerialInterface() {
   } else if (_iter_started              // check if our ContactsIterator is 'running'
              && !_serial->isWriteBusy() // don't spam the Serial Interface too quickly!
   ) {
+    uint32_t prev_session = _serial->getReplySession();
+    if (!_serial->setReplySession(_iter_session)) {   // keep to app that asked, even if others have sent commands since
+      _iter_started = false;   // that app has gone
+      return;
+    }
     ContactInfo contact;
-    if (_iter.hasNext(this, contact)) {
-      if (contact.lastmod > _iter_filter_since) { // apply the 'since' filter
+    bool eof;
+    if (app_target_ver >= 8) { // pack as many as will fit into each frame
+      int i = 0;
+      out_frame[i++] = RESP_CODE_CONTACTS_BATCH;
+      out_frame[i++] = 0;      // count
+      while (_iter.hasNext(this, contact)) {
+        if (contact.lastmod <= _iter_filter_since) continue; // apply the 'since' filter
+
+        int n = writeContactRecord(&out_frame[i], MAX_FRAME_SIZE - i, contact);
+        if (n == 0) {          // frame is full, this one goes in the next
+          _iter.putBack();
+          break;
+        }
+        i += n;
+        out_frame[1]++;
+        if (contact.lastmod > _most_recent_lastmod) {
+          _most_recent_lastmod = contact.lastmod; // save for the RESP_CODE_END_OF_CONTACTS frame
+        }
+      }
+      eof = out_frame[1] == 0;
+      if (!eof) _serial->writeFrame(out_frame, i);
+    } else {
+      eof = !_iter.hasNext(this, contact);
+      if (!eof && contact.lastmod > _iter_filter_since) { // apply the 'since' filter
         writeContactRespFrame(RESP_CODE_CONTACT, contact);
         if (contact.lastmod > _most_recent_lastmod) {
           _most_recent_lastmod = contact.lastmod; // save for the RESP_CODE_END_OF_CONTACTS frame
         }
       }
-    } else { // EOF
+    }
+    if (eof) {
       out_frame[0] = RESP_CODE_END_OF_CONTACTS;
       memcpy(&out_frame[1], &_most_recent_lastmod,
              4); // include the most recent lastmod, so app can update their 'since'
       _serial->writeFrame(out_frame, 5);
       _iter_started = false;
     }
+    _serial->setReplySession(prev_session);
+  } else if (_sync_credits > 0 && !_serial->isWriteBusy()) { // streaming messages (CMD_SYNC_MESSAGES)
+    uint32_t prev_session = _serial->getReplySession();
+    if (!_serial->setReplySession(_sync_session)) {   // (as above)
+      _sync_credits = 0;   // app has gone, so leave rest of messages queued
+      return;
+    }
+    int out_len;
+    if ((out_len = getFromOfflineQueue(out_frame)) > 0) {
+      _serial->writeFrame(out_frame, out_len);
+      _sync_credits--;
+#ifdef DISPLAY_CLASS
+      if (_ui) _ui->msgRead(offline_queue.count());
+#endif
+    } else {
+      out_frame[0] = RESP_CODE_NO_MORE_MESSAGES; // end of stream, app needs to grant credits again for more
+      _serial->writeFrame(out_frame, 1);
+      _sync_credits = 0;
+    }
+    _serial->setReplySession(prev_session);
   //} else if (!_serial->isWriteBusy()) {
   //  checkConnections();    // TODO - deprecate the 'Connections' stuff
   }
@@ -1711,6 +1844,12 @@ void MyMesh::loop() {
     dirty_contacts_expiry = 0;
   }
 
+  if (!_serial->isConnected() && (offline_flush_retry == 0 || millisHasNowPassed(offline_flush_retry))) {
+    // app has gone, so anything only in RAM should survive a reboot. But if filesystem is full/faulty, don't
+    // keep re-writing the log every loop
+    offline_flush_retry = offline_queue.flush() ? 0 : futureMillis(OFFLINE_FLUSH_RETRY_DELAY);
+  }
+
 #ifdef DISPLAY_CLASS
   if (_ui) _ui->setHasConnection(_serial->isConnected());
 #endif
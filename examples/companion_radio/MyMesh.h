@@ -5,7 +5,7 @@
 #include "AbstractUITask.h"
 
 /*------------ Frame Protocol --------------*/
-#define FIRMWARE_VER_CODE 7
+#define FIRMWARE_VER_CODE 8
 
 #ifndef FIRMWARE_BUILD_DATE
 #define FIRMWARE_BUILD_DATE "2 Oct 2025"
@@ -25,6 +25,7 @@
 
 #include "DataStore.h"
 #include "NodePrefs.h"
+#include "OfflineQueue.h"
 
 #include <RTClib.h>
 #include <helpers/ArduinoHelpers.h>
@@ -59,10 +60,6 @@
 #define MAX_CONTACTS 100
 #endif
 
-#ifndef OFFLINE_QUEUE_SIZE
-#define OFFLINE_QUEUE_SIZE 16
-#endif
-
 #ifndef BLE_NAME_PREFIX
 #define BLE_NAME_PREFIX "MeshCore-"
 #endif
@@ -151,6 +148,7 @@ private:
   void writeErrFrame(uint8_t err_code);
   void writeDisabledFrame();
   void writeContactRespFrame(uint8_t code, const ContactInfo &contact);
+  int writeContactRecord(uint8_t* dest, int max_len, const ContactInfo &contact);
   void updateContactFromFrame(ContactInfo &contact, uint32_t& last_mod, const uint8_t *frame, int len);
   void addToOfflineQueue(const uint8_t frame[], int len);
   int getFromOfflineQueue(uint8_t frame[]);
@@ -184,25 +182,22 @@ private:
   uint32_t _most_recent_lastmod;
   uint32_t _active_ble_pin;
   bool _iter_started;
+  uint8_t _sync_credits;   // messages app will still accept, from CMD_SYNC_MESSAGES
+  uint32_t _iter_session, _sync_session;   // which app each of those streams is for (see getReplySession())
   bool _cli_rescue;
   char cli_command[80];
   uint8_t app_target_ver;
-  uint8_t *sign_data;
+  mesh::SignContext sign_ctx;
+  bool sign_active;
   uint32_t sign_data_len;
   unsigned long dirty_contacts_expiry;
+  unsigned long offline_flush_retry;   // when to try spilling offline queue again, after a failure (0 = any time)
 
   uint8_t cmd_frame[MAX_FRAME_SIZE + 1];
   uint8_t out_frame[MAX_FRAME_SIZE + 1];
   CayenneLPP telemetry;
 
-  struct Frame {
-    uint8_t len;
-    uint8_t buf[MAX_FRAME_SIZE];
-
-    bool isChannelMsg() const;
-  };
-  int offline_queue_len;
-  Frame offline_queue[OFFLINE_QUEUE_SIZE];
+  OfflineQueue offline_queue;
 
   struct AckTableEntry {
     unsigned long msg_sent;
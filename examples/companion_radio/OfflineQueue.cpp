@@ -0,0 +1,299 @@
+#include "OfflineQueue.h"
+
+#define SPILL_LOG_FILE     "/offline_q"
+#define SPILL_POS_FILE     "/offline_qp"
+#define SPILL_TMP_FILE     "/offline_q.tmp"
+
+#define SPILL_MAX_BYTES    ((uint32_t)OFFLINE_SPILL_MAX_KB * 1024)
+#define SPILL_SAVE_EVERY   16   // reads between saving the read position
+
+// log record: len(1), is_channel(1), timestamp(4), frame(len)
+#define REC_HEADER_SIZE    6
+
+OfflineQueue::OfflineQueue(DataStore& store, mesh::RTCClock& clock) : _store(&store), _clock(&clock) {
+  _ring_head = _ring_count = 0;
+  _spill_pos = _spill_size = 0;
+  _spill_count = 0;
+  _reads_since_save = 0;
+}
+
+FILESYSTEM* OfflineQueue::getFS() const {
+  return _store->getSecondaryFS() ? _store->getSecondaryFS() : _store->getPrimaryFS();
+}
+
+static bool isExpired(const uint8_t hdr[], uint32_t now) {
+  uint32_t timestamp;
+  memcpy(&timestamp, &hdr[2], 4);
+  uint32_t max_age = hdr[1] ? OFFLINE_CHANNEL_MSG_MAX_AGE : OFFLINE_CONTACT_MSG_MAX_AGE;
+  return max_age > 0 && now > timestamp + max_age;
+}
+
+static bool isValidLen(uint8_t len) {
+  return len > 0 && len <= MAX_FRAME_SIZE;   // (anything else means log is corrupt)
+}
+
+void OfflineQueue::begin() {
+  _spill_pos = _spill_size = 0;
+  _spill_count = 0;
+
+  FILESYSTEM* fs = getFS();
+  File file = _store->openRead(fs, SPILL_LOG_FILE);
+  File tmp = _store->openRead(fs, SPILL_TMP_FILE);
+  if (tmp) {   // compact() was interrupted
+    tmp.close();
+    if (file) {   // ... before the new log was complete, so old one is still good
+      _store->removeFile(fs, SPILL_TMP_FILE);
+    } else {      // ... after the old log was removed, so finish the job
+      MESH_DEBUG_PRINTLN("offline queue: recovering compacted spill log");
+      _store->removeFile(fs, SPILL_POS_FILE);
+      _store->renameFile(fs, SPILL_TMP_FILE, SPILL_LOG_FILE);
+      file = _store->openRead(fs, SPILL_LOG_FILE);
+    }
+  }
+  if (!file) return;   // nothing was spilled
+
+  File pos_file = _store->openRead(fs, SPILL_POS_FILE);
+  if (pos_file) {
+    if (pos_file.read((uint8_t *) &_spill_pos, 4) != 4) _spill_pos = 0;
+    pos_file.close();
+  }
+  uint32_t size = file.size();
+  if (_spill_pos > size) _spill_pos = 0;
+
+  // count the unread records, and check the last one was completely written
+  uint32_t pos = _spill_pos;
+  uint8_t hdr[REC_HEADER_SIZE];
+  file.seek(pos);
+  while (pos + REC_HEADER_SIZE <= size && file.read(hdr, REC_HEADER_SIZE) == REC_HEADER_SIZE) {
+    if (!isValidLen(hdr[0]) || pos + REC_HEADER_SIZE + hdr[0] > size) break;
+    pos += REC_HEADER_SIZE + hdr[0];
+    file.seek(pos);
+    _spill_count++;
+  }
+  file.close();
+  _spill_size = pos;
+
+  if (_spill_count == 0) {
+    clearLog();
+  } else if (pos != size) {
+    MESH_DEBUG_PRINTLN("WARN: offline queue, partial or corrupt record in spill log");
+    compact(0);
+  }
+  MESH_DEBUG_PRINTLN("offline queue: %d messages in spill log", _spill_count);
+}
+
+void OfflineQueue::add(const uint8_t frame[], int len, bool is_channel, bool persist) {
+  if (len > MAX_FRAME_SIZE) len = MAX_FRAME_SIZE;
+
+  if (_ring_count >= OFFLINE_QUEUE_SIZE && !spillRing()) {
+    MESH_DEBUG_PRINTLN("WARN: offline queue is full, and can't spill!");
+    dropFromRing();
+  }
+  Frame& f = _ring[(_ring_head + _ring_count) % OFFLINE_QUEUE_SIZE];
+  f.len = len;
+  f.is_channel = is_channel;
+  f.timestamp = _clock->getCurrentTime();
+  memcpy(f.buf, frame, len);
+  _ring_count++;
+
+  if (persist) spillRing();   // (if this fails, it's at least still in RAM)
+}
+
+int OfflineQueue::get(uint8_t frame[]) {
+  if (_spill_count > 0) {   // oldest are in the log
+    File file = _store->openRead(getFS(), SPILL_LOG_FILE);
+    if (file) {
+      uint8_t hdr[REC_HEADER_SIZE];
+      int len = 0;
+      file.seek(_spill_pos);
+      if (file.read(hdr, REC_HEADER_SIZE) == REC_HEADER_SIZE && isValidLen(hdr[0]) && file.read(frame, hdr[0]) == hdr[0]) {
+        len = hdr[0];
+      }
+      file.close();
+
+      if (len > 0) {
+        _spill_pos += REC_HEADER_SIZE + len;
+        if (--_spill_count == 0) {
+          clearLog();
+        } else if (++_reads_since_save >= SPILL_SAVE_EVERY) {
+          saveReadPos();
+        }
+        return len;
+      }
+    }
+    MESH_DEBUG_PRINTLN("ERROR: offline queue, can't read spill log");
+    clearLog();   // give up on it, rather than get stuck
+  }
+
+  if (_ring_count > 0) {
+    const Frame& f = _ring[_ring_head];
+    memcpy(frame, f.buf, f.len);
+    _ring_head = (_ring_head + 1) % OFFLINE_QUEUE_SIZE;
+    _ring_count--;
+    return f.len;
+  }
+  return 0;   // queue is empty
+}
+
+bool OfflineQueue::flush() {
+  return _ring_count == 0 || spillRing();
+}
+
+bool OfflineQueue::spillRing() {
+  File file;
+  bool success = true, partial = false;
+  while (_ring_count > 0) {
+    const Frame& f = _ring[_ring_head];
+    uint32_t rec_len = REC_HEADER_SIZE + f.len;
+    if (_spill_size + rec_len > SPILL_MAX_BYTES) {
+      if (file) file.close();
+      if (!compact(rec_len)) {
+        success = false;
+        break;
+      }
+    }
+    if (!file) {
+      file = _store->openAppend(getFS(), SPILL_LOG_FILE);
+      if (!file) {
+        success = false;
+        break;
+      }
+    }
+
+    uint8_t hdr[REC_HEADER_SIZE];
+    hdr[0] = f.len;
+    hdr[1] = f.is_channel;
+    memcpy(&hdr[2], &f.timestamp, 4);
+    if (file.write(hdr, REC_HEADER_SIZE) != REC_HEADER_SIZE || file.write(f.buf, f.len) != f.len) {
+      success = false;
+      partial = true;
+      break;
+    }
+    _spill_size += rec_len;
+    _spill_count++;
+    _ring_head = (_ring_head + 1) % OFFLINE_QUEUE_SIZE;
+    _ring_count--;
+  }
+  if (file) file.close();
+
+  if (partial) {
+    MESH_DEBUG_PRINTLN("ERROR: offline queue, spill log write failed");
+    compact(0);   // re-write without the partial record
+  }
+  return success;
+}
+
+void OfflineQueue::dropFromRing() {
+  int idx = 0;
+  while (idx < _ring_count && !_ring[(_ring_head + idx) % OFFLINE_QUEUE_SIZE].is_channel) idx++;
+  if (idx == _ring_count) idx = 0;   // no channel messages, so drop oldest contact message
+
+  for (int i = idx; i > 0; i--) {   // close the gap, from the head side
+    _ring[(_ring_head + i) % OFFLINE_QUEUE_SIZE] = _ring[(_ring_head + i - 1) % OFFLINE_QUEUE_SIZE];
+  }
+  _ring_head = (_ring_head + 1) % OFFLINE_QUEUE_SIZE;
+  _ring_count--;
+}
+
+/*
+ * Re-writes the log without the records already read, and applies the retention rules: expired messages are
+ * dropped, then the oldest channel messages, then the oldest contact messages, until there's room for 'extra' bytes
+ * more, with the log at most 3/4 full (so this isn't needed again on the very next add).
+ */
+bool OfflineQueue::compact(uint32_t extra) {
+  FILESYSTEM* fs = getFS();
+  File src = _store->openRead(fs, SPILL_LOG_FILE);
+  if (!src) {
+    clearLog();
+    return extra <= SPILL_MAX_BYTES;
+  }
+  uint32_t now = _clock->getCurrentTime();
+  uint8_t hdr[REC_HEADER_SIZE];
+
+  uint32_t keep_contact = 0, keep_channel = 0;   // bytes, of unexpired records
+  for (uint32_t pos = _spill_pos; pos < _spill_size; pos += REC_HEADER_SIZE + hdr[0]) {
+    src.seek(pos);
+    if (src.read(hdr, REC_HEADER_SIZE) != REC_HEADER_SIZE || !isValidLen(hdr[0])) break;
+    if (isExpired(hdr, now)) continue;
+
+    if (hdr[1]) {
+      keep_channel += REC_HEADER_SIZE + hdr[0];
+    } else {
+      keep_contact += REC_HEADER_SIZE + hdr[0];
+    }
+  }
+  uint32_t drop_channel = 0, drop_contact = 0;
+  uint32_t target = SPILL_MAX_BYTES * 3 / 4;
+  if (keep_contact + keep_channel + extra > target) {
+    uint32_t excess = keep_contact + keep_channel + extra - target;
+    drop_channel = excess < keep_channel ? excess : keep_channel;
+    drop_contact = excess - drop_channel;
+  }
+
+  _store->removeFile(fs, SPILL_TMP_FILE);
+  File dest = _store->openAppend(fs, SPILL_TMP_FILE);
+  if (!dest) {
+    src.close();
+    return false;
+  }
+  uint32_t new_size = 0;
+  int new_count = 0, num_dropped = 0;
+  uint8_t buf[MAX_FRAME_SIZE];
+  for (uint32_t pos = _spill_pos; pos < _spill_size; pos += REC_HEADER_SIZE + hdr[0]) {
+    src.seek(pos);
+    if (src.read(hdr, REC_HEADER_SIZE) != REC_HEADER_SIZE || !isValidLen(hdr[0]) || src.read(buf, hdr[0]) != hdr[0]) break;
+
+    uint32_t rec_len = REC_HEADER_SIZE + hdr[0];
+    uint32_t& drop = hdr[1] ? drop_channel : drop_contact;
+    if (isExpired(hdr, now)) {
+      num_dropped++;
+    } else if (drop > 0) {
+      drop = rec_len < drop ? drop - rec_len : 0;
+      num_dropped++;
+    } else {
+      if (dest.write(hdr, REC_HEADER_SIZE) != REC_HEADER_SIZE || dest.write(buf, hdr[0]) != hdr[0]) {
+        dest.close();
+        src.close();
+        _store->removeFile(fs, SPILL_TMP_FILE);
+        return false;
+      }
+      new_size += rec_len;
+      new_count++;
+    }
+  }
+  src.close();
+  dest.close();
+
+  // NOTE: if interrupted from here on, begin() completes the swap
+  _store->removeFile(fs, SPILL_LOG_FILE);
+  _store->removeFile(fs, SPILL_POS_FILE);   // ie. read position = 0
+  _store->renameFile(fs, SPILL_TMP_FILE, SPILL_LOG_FILE);
+  _spill_pos = 0;
+  _spill_size = new_size;
+  _spill_count = new_count;
+  _reads_since_save = 0;
+  if (num_dropped > 0) {
+    MESH_DEBUG_PRINTLN("offline queue: spill log full, %d messages dropped", num_dropped);
+  }
+  return new_size + extra <= SPILL_MAX_BYTES;
+}
+
+void OfflineQueue::saveReadPos() {
+  FILESYSTEM* fs = getFS();
+  _store->removeFile(fs, SPILL_POS_FILE);
+  File file = _store->openAppend(fs, SPILL_POS_FILE);
+  if (file) {
+    file.write((const uint8_t *) &_spill_pos, 4);
+    file.close();
+  }
+  _reads_since_save = 0;
+}
+
+void OfflineQueue::clearLog() {
+  FILESYSTEM* fs = getFS();
+  _store->removeFile(fs, SPILL_LOG_FILE);
+  _store->removeFile(fs, SPILL_POS_FILE);
+  _spill_pos = _spill_size = 0;
+  _spill_count = 0;
+  _reads_since_save = 0;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <Arduino.h>
+#include <helpers/BaseSerialInterface.h>
+#include "DataStore.h"
+
+#ifndef OFFLINE_QUEUE_SIZE
+  #define OFFLINE_QUEUE_SIZE   16    // frames held in RAM, before spilling to the log
+#endif
+
+#ifndef OFFLINE_SPILL_MAX_KB
+  #if (defined(NRF52_PLATFORM) || defined(STM32_PLATFORM)) && !defined(EXTRAFS) && !defined(QSPIFLASH)
+    #define OFFLINE_SPILL_MAX_KB   8     // small internal flash only
+  #else
+    #define OFFLINE_SPILL_MAX_KB   128
+  #endif
+#endif
+
+// retention, in secs (0 = no limit). Expired messages are dropped when the spill log needs space, then (if still
+// needed) the oldest channel messages, and only then the oldest contact messages.
+#ifndef OFFLINE_CHANNEL_MSG_MAX_AGE
+  #define OFFLINE_CHANNEL_MSG_MAX_AGE   (2*24*60*60)
+#endif
+#ifndef OFFLINE_CONTACT_MSG_MAX_AGE
+  #define OFFLINE_CONTACT_MSG_MAX_AGE   0
+#endif
+
+/**
+ * \brief  Messages waiting for the app, in arrival order. The newest are in a RAM ring buffer, and older ones in an
+ *         append-only spill log on the DataStore's (larger) filesystem, so they survive reboots:
+ *             [ spill log (oldest) ] [ RAM ring (newest) ]
+ *         The ring is spilled as a whole when it fills, or straight away when the app isn't connected.
+ *         The log is only re-written when it runs out of space (applying the retention rules), or removed when
+ *         it has all been read. The read position is saved every few reads, so after a crash some messages may
+ *         be delivered again (but none lost).
+ */
+class OfflineQueue {
+  struct Frame {
+    uint8_t len;
+    uint8_t is_channel;
+    uint32_t timestamp;   // arrival, by our clock
+    uint8_t buf[MAX_FRAME_SIZE];
+  };
+
+  DataStore* _store;
+  mesh::RTCClock* _clock;
+  Frame _ring[OFFLINE_QUEUE_SIZE];
+  int _ring_head, _ring_count;
+  uint32_t _spill_pos, _spill_size;   // read position, and end of log
+  int _spill_count;                   // unread records in log
+  int _reads_since_save;
+
+  FILESYSTEM* getFS() const;
+  bool spillRing();
+  void dropFromRing();
+  bool compact(uint32_t extra);
+  void saveReadPos();
+  void clearLog();
+
+public:
+  OfflineQueue(DataStore& store, mesh::RTCClock& clock);
+
+  /**
+   * \brief  picks up any messages left in the spill log (eg. before a reboot)
+   */
+  void begin();
+
+  /**
+   * \param  persist  write to the log now, instead of in RAM (ie. when no app is connected to take it soon)
+   */
+  void add(const uint8_t frame[], int len, bool is_channel, bool persist);
+
+  /**
+   * \returns  length of oldest frame (now removed from queue), or 0 if queue is empty
+   */
+  int get(uint8_t frame[]);
+
+  /**
+   * \brief  spill anything still only in RAM to the log, eg. before rebooting
+   * \returns  false if some couldn't be written (ie. are still only in RAM)
+   */
+  bool flush();
+
+  int count() const { return _ring_count + _spill_count; }
+  int getNumSpilled() const { return _spill_count; }
+};
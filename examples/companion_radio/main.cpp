@@ -32,6 +32,8 @@ static uint32_t _atoi(const char* sp) {
 #elif defined(ESP32)
   #include <SPIFFS.h>
   DataStore store(SPIFFS, rtc_clock);
+#elif defined(LINUX_PLATFORM)
+  DataStore store(RAMFS, rtc_clock);
 #endif
 
 #ifdef ESP32
@@ -81,6 +83,14 @@ static uint32_t _atoi(const char* sp) {
 #elif defined(STM32_PLATFORM)
   #include <helpers/ArduinoSerialInterface.h>
   ArduinoSerialInterface serial_interface;
+#elif defined(LINUX_PLATFORM)
+  #ifdef TCP_PORT
+    #include <helpers/linux/SerialTCPInterface.h>
+    SerialTCPInterface serial_interface;
+  #else
+    #include <helpers/ArduinoSerialInterface.h>
+    ArduinoSerialInterface serial_interface;
+  #endif
 #else
   #error "need to define a serial interface"
 #endif
@@ -210,6 +220,25 @@ void setup() {
   serial_interface.begin(Serial);
 #endif
   the_mesh.startInterface(serial_interface);
+#elif defined(LINUX_PLATFORM)
+  RAMFS.begin();
+  store.begin();
+  the_mesh.begin(
+    #ifdef DISPLAY_CLASS
+        disp != NULL
+    #else
+        false
+    #endif
+  );
+#ifdef TCP_PORT
+  if (!serial_interface.begin(TCP_PORT)) {
+    Serial.printf("ERROR: can't listen on TCP port %d\n", TCP_PORT);
+    halt();
+  }
+#else
+  serial_interface.begin(Serial);
+#endif
+  the_mesh.startInterface(serial_interface);
 #else
   #error "need to define filesystem"
 #endif
@@ -0,0 +1,209 @@
+#include <Arduino.h>   // needed for PlatformIO
+#include <Mesh.h>
+#include <SHA256Batch.h>
+#include <helpers/ArduinoHelpers.h>
+
+/*
+ * Checks the selected MESH_CRYPTO_BACKEND against standard test vectors, then reports its throughput for the
+ * operations the mesh actually does. Build once per backend, to compare, eg:
+ *    pio run -e linux_native_crypto_benchmark && .pio/build/linux_native_crypto_benchmark/program
+ *    pio run -e linux_native_crypto_benchmark_soft && .pio/build/linux_native_crypto_benchmark_soft/program
+ */
+
+#define BENCH_MILLIS   500    // run each test for (at least) this long
+
+static bool checkVectors() {
+  bool ok = true;
+
+  // FIPS-197, appendix C.1
+  uint8_t key[16], pt[16], ct[16], out[16];
+  for (int i = 0; i < 16; i++) { key[i] = i; pt[i] = i * 0x11; }
+  static const uint8_t aes_expected[16] = {
+    0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+  };
+  mesh::CryptoAES128 aes;
+  aes.setKey(key, 16);
+  aes.encryptBlocks(ct, pt, 1);
+  aes.decryptBlocks(out, ct, 1);
+  if (memcmp(ct, aes_expected, 16) != 0 || memcmp(out, pt, 16) != 0) {
+    Serial.println("FAIL: AES-128 (FIPS-197 C.1)");
+    ok = false;
+  }
+
+  // FIPS-180-2, 'abc', and two block message
+  static const uint8_t sha_abc[32] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+  };
+  static const uint8_t sha_448[32] = {
+    0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+    0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1
+  };
+  const char* msg = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  uint8_t hash[32];
+  mesh::Utils::sha256(hash, 32, (const uint8_t *) "abc", 3);
+  if (memcmp(hash, sha_abc, 32) != 0) {
+    Serial.println("FAIL: SHA-256 ('abc')");
+    ok = false;
+  }
+  mesh::Utils::sha256(hash, 32, (const uint8_t *) msg, 20, (const uint8_t *) &msg[20], strlen(msg) - 20);
+  if (memcmp(hash, sha_448, 32) != 0) {
+    Serial.println("FAIL: SHA-256 (448 bit msg)");
+    ok = false;
+  }
+
+  // batched, against the single hashes (lengths either side of the padding boundaries)
+  static uint8_t batch_src[200];
+  const uint8_t* msgs[11];
+  int lens[11];
+  uint8_t batch_hashes[11*32];
+  for (int i = 0; i < (int) sizeof(batch_src); i++) batch_src[i] = i * 31 + 7;
+  for (int i = 0; i < 11; i++) {
+    msgs[i] = &batch_src[i];
+    lens[i] = i * 18;   // 0 .. 180
+  }
+  mesh::SHA256Batch::hash(batch_hashes, 32, msgs, lens, 11);
+  for (int i = 0; i < 11; i++) {
+    mesh::Utils::sha256(hash, 32, msgs[i], lens[i]);
+    if (memcmp(hash, &batch_hashes[i*32], 32) != 0) {
+      Serial.printf("FAIL: SHA256Batch (%d bytes)\n", lens[i]);
+      ok = false;
+    }
+  }
+
+  // round trip, and that a corrupted MAC is rejected
+  uint8_t secret[PUB_KEY_SIZE], data[100], enc[MAX_PACKET_PAYLOAD], dec[MAX_PACKET_PAYLOAD];
+  for (int i = 0; i < PUB_KEY_SIZE; i++) secret[i] = i * 7 + 1;
+  for (int i = 0; i < (int) sizeof(data); i++) data[i] = i;
+  int len = mesh::Utils::encryptThenMAC(secret, enc, data, sizeof(data));
+  if (mesh::Utils::MACThenDecrypt(secret, dec, enc, len) < (int) sizeof(data) || memcmp(dec, data, sizeof(data)) != 0) {
+    Serial.println("FAIL: encryptThenMAC() -> MACThenDecrypt()");
+    ok = false;
+  }
+  enc[0] ^= 1;
+  if (mesh::Utils::MACThenDecrypt(secret, dec, enc, len) != 0) {
+    Serial.println("FAIL: MACThenDecrypt() accepted bad MAC");
+    ok = false;
+  }
+  return ok;
+}
+
+static void report(const char* name, uint32_t count, uint32_t bytes_each, unsigned long elapsed_micros) {
+  float secs = elapsed_micros / 1000000.0f;
+  Serial.printf("  %-34s %9.0f ops/s  %8.1f KB/s\n", name, count / secs, count * bytes_each / 1024.0f / secs);
+}
+
+#define BENCH(name, bytes_each, op)  do { \
+    uint32_t n = 0; \
+    unsigned long start = micros(), elapsed; \
+    do { \
+      for (int i = 0; i < 16; i++) { op; } \
+      n += 16; \
+      elapsed = micros() - start; \
+    } while (elapsed < BENCH_MILLIS*1000UL); \
+    report(name, n, bytes_each, elapsed); \
+  } while (0)
+
+static uint8_t secret[PUB_KEY_SIZE];
+static StdRNG rng;
+static mesh::Packet packets[8];
+static uint8_t src[MAX_PACKET_PAYLOAD], enc[MAX_PACKET_PAYLOAD], dec[MAX_PACKET_PAYLOAD];
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+
+  Serial.printf("MESH_CRYPTO_BACKEND: %s, SHA256Batch: %s\n", MESH_CRYPTO_BACKEND_NAME, mesh::SHA256Batch::getImplName());
+  if (!checkVectors()) {
+    Serial.println("test vectors FAILED, not benchmarking");
+    return;
+  }
+  Serial.println("test vectors OK");
+
+  for (int i = 0; i < PUB_KEY_SIZE; i++) secret[i] = i * 13 + 5;
+  for (int i = 0; i < (int) sizeof(src); i++) src[i] = i;
+
+  mesh::CryptoAES128 aes;
+  aes.setKey(secret, CIPHER_KEY_SIZE);
+  BENCH("AES-128 key setup", 16, aes.setKey(secret, CIPHER_KEY_SIZE));
+  BENCH("AES-128 encrypt (160 bytes)", 160, aes.encryptBlocks(enc, src, 10));
+  BENCH("AES-128 decrypt (160 bytes)", 160, aes.decryptBlocks(dec, enc, 10));
+  BENCH("SHA-256 (160 bytes)", 160, mesh::Utils::sha256(dec, 32, src, 160));
+
+  // packet hashes (not cached), one at a time vs batched, as for a host tool working through a log
+  const mesh::Packet* pkt_ptrs[8];
+  for (int i = 0; i < 8; i++) {
+    packets[i].header = PAYLOAD_TYPE_TXT_MSG << PH_TYPE_SHIFT;
+    packets[i].payload_len = 100 + i;
+    memcpy(packets[i].payload, &src[i], packets[i].payload_len);
+    pkt_ptrs[i] = &packets[i];
+  }
+  BENCH("Packet::calculatePacketHash (x8)", 8*100, for (int j = 0; j < 8; j++) { packets[j].invalidateHash(); packets[j].calculatePacketHash(dec); });
+  BENCH("Packet::hashPackets (x8)", 8*100,
+    for (int j = 0; j < 8; j++) packets[j].invalidateHash(); mesh::Packet::hashPackets(pkt_ptrs, 8, dec));
+
+  // keyed state already cached, as for repeat traffic with a peer (see Mesh::getCipher())
+  mesh::CipherContext ctx;
+  ctx.setSecret(secret);
+  BENCH("encryptThenMAC (32 bytes)", 32, ctx.encryptThenMAC(enc, src, 32));
+  int len = ctx.encryptThenMAC(enc, src, 160);
+  BENCH("encryptThenMAC (160 bytes)", 160, ctx.encryptThenMAC(enc, src, 160));
+  BENCH("MACThenDecrypt (160 bytes)", 160, ctx.MACThenDecrypt(dec, enc, len));
+  enc[0] ^= 1;
+  BENCH("verifyMAC, bad MAC (160 bytes)", 160, ctx.verifyMAC(enc, len));
+  enc[0] ^= 1;
+
+  // cold, ie. with key setup each time
+  BENCH("Utils::MACThenDecrypt (160 bytes)", 160, mesh::Utils::MACThenDecrypt(secret, dec, enc, len));
+
+  // cold vs cached keyed state, for a typical datagram: a round trip, and a MAC check on a wrong candidate peer
+  mesh::CipherContextCache cache(8);
+  len = mesh::Utils::encryptThenMAC(secret, enc, src, 48);
+  BENCH("cold encrypt+decrypt (48 bytes)", 48,
+    mesh::Utils::encryptThenMAC(secret, enc, src, 48); mesh::Utils::MACThenDecrypt(secret, dec, enc, len));
+  BENCH("cached encrypt+decrypt (48 bytes)", 48,
+    mesh::CipherContext& c = cache.get(secret); c.encryptThenMAC(enc, src, 48); c.MACThenDecrypt(dec, enc, len));
+  enc[0] ^= 1;
+  BENCH("cold bad MAC (48 bytes)", 48, mesh::Utils::MACThenDecrypt(secret, dec, enc, len));
+  BENCH("cached bad MAC (48 bytes)", 48, cache.get(secret).verifyMAC(enc, len));
+  enc[0] ^= 1;
+
+  // advert signatures (pub_key, timestamp, app_data), one at a time vs a batch of MESH_ADVERT_BATCH_SIZE
+  {
+    const int batch = MESH_ADVERT_BATCH_SIZE;   // (NOT 'n', which BENCH() uses)
+    static uint8_t msgs[MESH_ADVERT_BATCH_SIZE][PUB_KEY_SIZE + 4 + 24];
+    static uint8_t sigs[MESH_ADVERT_BATCH_SIZE][SIGNATURE_SIZE];
+    const uint8_t* sig_ptrs[MESH_ADVERT_BATCH_SIZE];
+    const uint8_t* msg_ptrs[MESH_ADVERT_BATCH_SIZE];
+    int msg_lens[MESH_ADVERT_BATCH_SIZE];
+    rng.begin(12345);
+    for (int i = 0; i < batch; i++) {
+      mesh::LocalIdentity id(&rng);
+      memcpy(msgs[i], id.pub_key, PUB_KEY_SIZE);
+      rng.random(&msgs[i][PUB_KEY_SIZE], sizeof(msgs[i]) - PUB_KEY_SIZE);
+      id.sign(sigs[i], msgs[i], sizeof(msgs[i]));
+      sig_ptrs[i] = sigs[i]; msg_ptrs[i] = msgs[i]; msg_lens[i] = sizeof(msgs[i]);
+    }
+    bool all_ok = mesh::Identity::verifyBatch(sig_ptrs, msg_ptrs, msg_ptrs, msg_lens, batch, rng);
+    for (int i = 0; i < batch; i++) all_ok = all_ok && mesh::Identity(msgs[i]).verify(sigs[i], msgs[i], msg_lens[i]);
+    sigs[batch - 1][40] ^= 1;
+    if (!all_ok || mesh::Identity::verifyBatch(sig_ptrs, msg_ptrs, msg_ptrs, msg_lens, batch, rng)) {
+      Serial.println("FAIL: Identity::verifyBatch()");
+    }
+    sigs[batch - 1][40] ^= 1;
+
+    // (ops/s = adverts/s, in both)
+    char name[40];
+    BENCH("advert verify", 0, mesh::Identity(msgs[i % batch]).verify(sigs[i % batch], msgs[i % batch], msg_lens[i % batch]));
+    snprintf(name, sizeof(name), "advert verifyBatch (of %d)", batch);
+    BENCH(name, 0, if (i % batch == 0) mesh::Identity::verifyBatch(sig_ptrs, msg_ptrs, msg_ptrs, msg_lens, batch, rng));
+  }
+
+  Serial.println("done");
+#if defined(LINUX_PLATFORM)
+  exit(0);
+#endif
+}
+
+void loop() {
+}
@@ -0,0 +1,332 @@
+#include <Arduino.h>
+#include <Mesh.h>
+#include <MeshCore.h>
+#include <cstdint>
+#include <RTClib.h>
+#include <helpers/ArduinoHelpers.h>
+#include <helpers/BaseSerialInterface.h>
+#include <helpers/IdentityStore.h>
+#include <helpers/ContactInfo.h>
+#include <helpers/ChannelDetails.h>
+#include <helpers/SimpleMeshTables.h>
+#include <helpers/StaticPoolPacketManager.h>
+#include <helpers/SensorManager.h>
+#include <helpers/TxtDataHelpers.h>
+#include <helpers/ui/DisplayDriver.h>
+#include <helpers/ui/UIScreen.h>
+#include <helpers/BaseChatMesh.h>
+#include <target.h>
+#include <deque>
+#include <vector>
+#include "SimNode.h"
+
+// The companion_radio firmware, compiled into its own namespace (see RepeaterNode.cpp)
+namespace companion {
+  #include "../companion_radio/MyMesh.h"
+  #include "../companion_radio/DataStore.cpp"
+  #include "../companion_radio/OfflineQueue.cpp"
+  #include "../companion_radio/MyMesh.cpp"
+}
+
+#define BLE_WRITE_MIN_INTERVAL   60   // as the esp32/nrf52 SerialBLEInterface
+#define BLE_APP_TURNAROUND      100   // from a frame being sent, to the app's reply arriving (~2 connection intervals)
+
+/**
+ * \brief  A companion radio, with a scripted 'app' attached to its serial interface. The app just drains the
+ *         offline message queue as messages arrive, and keeps delivery counts.
+ */
+class CompanionNode : public SimNode, public BaseSerialInterface {
+  SimClock& _clock;
+  companion::DataStore _store;
+  companion::MyMesh _mesh;
+  struct CmdFrame {
+    unsigned long ready;   // when it reaches the device
+    std::vector<uint8_t> buf;
+  };
+  std::deque<CmdFrame> _cmd_frames;
+  bool _enabled, _app_away;
+  uint32_t n_sent, n_errors, n_confirmed, n_recv, n_chan_recv, n_adverts, n_logins, n_login_fails;
+
+  // once a sync is started, the link is modelled as BLE: device writes spaced apart, and app replies delayed
+  bool _ble_paced;
+  unsigned long _link_free_at, _reply_delay;
+  // contacts sync (see "contacts.sync")
+  int _sync_ver;
+  unsigned long _sync_start;
+  uint32_t _sync_frames, _sync_bytes, _sync_contacts, _sync_bad;
+  // messages sync (see "msgs.sync")
+  int _msgs_window, _msgs_since_grant;
+  unsigned long _msgs_start;
+  uint32_t _msgs_synced;
+
+  void queueFrame(const uint8_t* frame, size_t len, unsigned long delay = 0) {
+    CmdFrame f;
+    f.ready = _clock.getMillis() + delay;
+    f.buf.assign(frame, frame + len);
+    _cmd_frames.push_back(f);
+  }
+
+  void queueSyncCmd(unsigned long delay) {
+    uint8_t frame[2];
+    if (_msgs_window > 0) {   // grant credits for a whole window
+      frame[0] = CMD_SYNC_MESSAGES;
+      frame[1] = _msgs_window;
+      _msgs_since_grant = 0;
+      queueFrame(frame, 2, delay);
+    } else {
+      frame[0] = CMD_SYNC_NEXT_MESSAGE;
+      queueFrame(frame, 1, delay);
+    }
+  }
+
+  void onMsgRecv() {
+    if (_msgs_window == 0) {
+      queueSyncCmd(_reply_delay);   // keep draining, one request per message
+    } else if (++_msgs_since_grant >= _msgs_window / 2) {   // top up credits, before they run out
+      uint8_t frame[2];
+      frame[0] = CMD_SYNC_MESSAGES;
+      frame[1] = _msgs_since_grant;
+      _msgs_since_grant = 0;
+      queueFrame(frame, 2, _reply_delay);
+    }
+    if (_msgs_start) _msgs_synced++;
+  }
+
+public:
+  CompanionNode(const char* name, SimClock& clock, uint32_t seed, uint32_t epoch)
+    : SimNode(name, clock, seed, epoch), _clock(clock), _store(fs, rtc), _mesh(radio, rng, rtc, tables, _store) {
+    _enabled = _app_away = false;
+    n_sent = n_errors = n_confirmed = n_recv = n_chan_recv = n_adverts = n_logins = n_login_fails = 0;
+    _ble_paced = false;
+    _link_free_at = _reply_delay = 0;
+    _sync_ver = 0;
+    _msgs_window = _msgs_since_grant = 0;
+    _msgs_start = 0;
+  }
+
+  const char* getType() const override { return "companion"; }
+  mesh::Mesh& getMesh() override { return _mesh; }
+
+  void begin() override {
+    _store.begin();
+    _mesh.begin(false);
+    _mesh.startInterface(*this);
+
+    uint8_t frame[1 + sizeof(_name)];
+    frame[0] = CMD_SET_ADVERT_NAME;
+    int len = strlen(_name);
+    memcpy(&frame[1], _name, len);
+    queueFrame(frame, 1 + len);
+  }
+
+  void loop() override { _mesh.loop(); }
+
+  void handleCommand(char* command, char* reply) override {
+    uint8_t frame[MAX_FRAME_SIZE];
+    reply[0] = 0;
+    if (strcmp(command, "advert") == 0 || strcmp(command, "advert.zerohop") == 0) {
+      frame[0] = CMD_SEND_SELF_ADVERT;
+      frame[1] = command[6] == 0 ? 1 : 0;   // flood, or zero hop
+      queueFrame(frame, 2);
+    } else if (memcmp(command, "msg ", 4) == 0) {   // msg {dest-node} {text}
+      char* dest_name = &command[4];
+      char* text = strchr(dest_name, ' ');
+      if (text == NULL) {
+        strcpy(reply, "ERR: msg {dest} {text}");
+        return;
+      }
+      *text++ = 0;
+      SimNode* dest = findSimNode(dest_name);
+      if (dest == NULL) {
+        sprintf(reply, "ERR: unknown node: %s", dest_name);
+        return;
+      }
+      int i = 0;
+      frame[i++] = CMD_SEND_TXT_MSG;
+      frame[i++] = TXT_TYPE_PLAIN;
+      frame[i++] = 0;   // attempt
+      uint32_t timestamp = rtc.getCurrentTimeUnique();
+      memcpy(&frame[i], &timestamp, 4); i += 4;
+      memcpy(&frame[i], dest->getMesh().self_id.pub_key, 6); i += 6;
+      int tlen = min((int)strlen(text), MAX_FRAME_SIZE - 1 - i);
+      memcpy(&frame[i], text, tlen); i += tlen;
+      queueFrame(frame, i);
+    } else if (memcmp(command, "chan ", 5) == 0) {   // chan {text}   (to the Public channel)
+      int i = 0;
+      frame[i++] = CMD_SEND_CHANNEL_TXT_MSG;
+      frame[i++] = TXT_TYPE_PLAIN;
+      frame[i++] = 0;   // channel_idx
+      uint32_t timestamp = rtc.getCurrentTimeUnique();
+      memcpy(&frame[i], &timestamp, 4); i += 4;
+      int tlen = min((int)strlen(&command[5]), MAX_FRAME_SIZE - 1 - i);
+      memcpy(&frame[i], &command[5], tlen); i += tlen;
+      queueFrame(frame, i);
+    } else if (memcmp(command, "login ", 6) == 0) {   // login {dest-node} {password}
+      char* dest_name = &command[6];
+      char* password = strchr(dest_name, ' ');
+      if (password == NULL) {
+        strcpy(reply, "ERR: login {dest} {password}");
+        return;
+      }
+      *password++ = 0;
+      SimNode* dest = findSimNode(dest_name);
+      if (dest == NULL) {
+        sprintf(reply, "ERR: unknown node: %s", dest_name);
+        return;
+      }
+      int i = 0;
+      frame[i++] = CMD_SEND_LOGIN;
+      memcpy(&frame[i], dest->getMesh().self_id.pub_key, PUB_KEY_SIZE); i += PUB_KEY_SIZE;
+      int plen = min((int)strlen(password), 15);
+      memcpy(&frame[i], password, plen); i += plen;
+      queueFrame(frame, i);
+    } else if (memcmp(command, "contacts.fill ", 14) == 0) {   // contacts.fill {count}   (made up contacts)
+      int count = atoi(&command[14]);
+      for (int n = 0; n < count; n++) {
+        int i = 0;
+        frame[i++] = CMD_ADD_UPDATE_CONTACT;
+        rng.random(&frame[i], PUB_KEY_SIZE); i += PUB_KEY_SIZE;
+        frame[i++] = n % 8 == 0 ? ADV_TYPE_REPEATER : ADV_TYPE_CHAT;
+        frame[i++] = 0;   // flags
+        int path_len = n % 3 == 0 ? -1 : n % 4;   // some unknown, some direct, some 1..3 hops
+        frame[i++] = path_len;
+        memset(&frame[i], 0, MAX_PATH_SIZE);
+        if (path_len > 0) rng.random(&frame[i], path_len);
+        i += MAX_PATH_SIZE;
+        memset(&frame[i], 0, 32);
+        sprintf((char *)&frame[i], "contact %d", n);
+        i += 32;
+        uint32_t timestamp = rtc.getCurrentTime() - n * 60;
+        memcpy(&frame[i], &timestamp, 4); i += 4;
+        int32_t lat = 0, lon = 0;
+        if (n % 4 == 0) {   // some have a location
+          lat = -37000000 - n;
+          lon = 144000000 + n;
+        }
+        memcpy(&frame[i], &lat, 4); i += 4;
+        memcpy(&frame[i], &lon, 4); i += 4;
+        queueFrame(frame, i);
+      }
+    } else if (memcmp(command, "contacts.sync ", 14) == 0) {   // contacts.sync {app-ver}
+      _sync_ver = atoi(&command[14]);
+      _sync_start = _clock.getMillis();
+      _sync_frames = _sync_bytes = _sync_contacts = _sync_bad = 0;
+      _ble_paced = true;
+      frame[0] = CMD_DEVICE_QEURY;
+      frame[1] = _sync_ver;
+      queueFrame(frame, 2);
+      frame[0] = CMD_GET_CONTACTS;
+      queueFrame(frame, 1);
+    } else if (strcmp(command, "app.away") == 0) {   // app disconnected, so messages pile up in offline queue
+      _app_away = true;
+    } else if (memcmp(command, "msgs.sync ", 10) == 0) {   // msgs.sync {window}   (0 = CMD_SYNC_NEXT_MESSAGE each)
+      _app_away = false;
+      _ble_paced = true;
+      _msgs_window = atoi(&command[10]);
+      _msgs_start = _clock.getMillis();
+      _msgs_synced = 0;
+      queueSyncCmd(0);
+    } else {
+      strcpy(reply, "ERR: unknown command (advert, advert.zerohop, msg, chan, login, contacts.fill, contacts.sync, "
+                    "app.away, msgs.sync)");
+    }
+  }
+
+  void printStats(Stream& out) override {
+    out.printf(" msgs(sent=%u err=%u confirmed=%u recv=%u chan=%u) adverts=%u",
+      n_sent, n_errors, n_confirmed, n_recv, n_chan_recv, n_adverts);
+    if (n_logins + n_login_fails > 0) {
+      out.printf(" logins(ok=%u fail=%u)", n_logins, n_login_fails);
+    }
+  }
+
+  // BaseSerialInterface, ie. the scripted 'app'
+  void enable() override { _enabled = true; }
+  void disable() override { _enabled = false; }
+  bool isEnabled() const override { return _enabled; }
+  bool isConnected() const override { return _enabled && !_app_away; }
+  bool isWriteBusy() const override {
+    return _ble_paced && _clock.getMillis() < _link_free_at;
+  }
+
+  void onContactsFrame(const uint8_t src[], size_t len) {
+    _sync_frames++;
+    _sync_bytes += len;
+    if (src[0] == RESP_CODE_CONTACT) {
+      _sync_contacts++;
+    } else if (src[0] == RESP_CODE_CONTACTS_BATCH) {   // check the records add up
+      size_t i = 2;
+      for (int n = 0; n < src[1]; n++) {
+        if (i >= len || i + 1 + src[i] > len) { _sync_bad++; break; }
+        i += 1 + src[i];
+        _sync_contacts++;
+      }
+      if (i != len) _sync_bad++;
+    } else if (src[0] == RESP_CODE_END_OF_CONTACTS) {
+      Serial.printf("%8lu %s: contacts.sync (ver %d): %u contacts, %u frames, %u bytes, %lu ms%s\n",
+        _clock.getMillis(), _name, _sync_ver, _sync_contacts, _sync_frames, _sync_bytes,
+        _clock.getMillis() - _sync_start, _sync_bad ? " BAD FRAMES" : "");
+    }
+  }
+
+  size_t writeFrame(const uint8_t src[], size_t len) override {
+    if (_ble_paced) {   // queued behind any earlier writes, then the app takes a while to reply
+      unsigned long now = _clock.getMillis();
+      unsigned long sent = max(now, _link_free_at);
+      _link_free_at = sent + BLE_WRITE_MIN_INTERVAL;
+      _reply_delay = sent - now + BLE_APP_TURNAROUND;
+    }
+    if (_app_away) return len;
+
+    switch (src[0]) {
+    case RESP_CODE_SENT: n_sent++; break;
+    case RESP_CODE_ERR: n_errors++; break;
+    case PUSH_CODE_SEND_CONFIRMED: n_confirmed++; break;
+    case PUSH_CODE_ADVERT:
+    case PUSH_CODE_NEW_ADVERT: n_adverts++; break;
+    case PUSH_CODE_LOGIN_SUCCESS: n_logins++; break;
+    case PUSH_CODE_LOGIN_FAIL: n_login_fails++; break;
+    case PUSH_CODE_MSG_WAITING:
+      queueSyncCmd(_reply_delay);
+      break;
+    case RESP_CODE_CONTACT_MSG_RECV:
+    case RESP_CODE_CONTACT_MSG_RECV_V3:
+      n_recv++;
+      onMsgRecv();
+      break;
+    case RESP_CODE_CHANNEL_MSG_RECV:
+    case RESP_CODE_CHANNEL_MSG_RECV_V3:
+      n_chan_recv++;
+      onMsgRecv();
+      break;
+    case RESP_CODE_NO_MORE_MESSAGES:
+      if (_msgs_start) {
+        Serial.printf("%8lu %s: msgs.sync (window %d): %u msgs, %lu ms\n", _clock.getMillis(), _name, _msgs_window,
+          _msgs_synced, _clock.getMillis() - _msgs_start);
+        _msgs_start = 0;
+      }
+      break;
+    case RESP_CODE_CONTACTS_START:
+    case RESP_CODE_CONTACT:
+    case RESP_CODE_CONTACTS_BATCH:
+    case RESP_CODE_END_OF_CONTACTS:
+      onContactsFrame(src, len);
+      break;
+    }
+    return len;
+  }
+
+  size_t checkRecvFrame(uint8_t dest[]) override {
+    if (_cmd_frames.empty() || _clock.getMillis() < _cmd_frames.front().ready) return 0;
+
+    std::vector<uint8_t>& f = _cmd_frames.front().buf;
+    size_t len = f.size();
+    memcpy(dest, f.data(), len);
+    _cmd_frames.pop_front();
+    return len;
+  }
+};
+
+SimNode* createCompanionNode(const char* name, SimClock& clock, uint32_t seed, uint32_t epoch) {
+  return new CompanionNode(name, clock, seed, epoch);
+}
@@ -0,0 +1,55 @@
+#include <Arduino.h>
+#include <Mesh.h>
+#include <helpers/CommonCLI.h>
+#include <helpers/ArduinoHelpers.h>
+#include <helpers/StaticPoolPacketManager.h>
+#include <helpers/CompactPacketManager.h>
+#include <helpers/SimpleMeshTables.h>
+#include <helpers/IdentityStore.h>
+#include <helpers/AdvertDataHelpers.h>
+#include <helpers/TxtDataHelpers.h>
+#include <helpers/ClientACL.h>
+#include <RTClib.h>
+#include <target.h>
+#include <algorithm>
+#include "SimNode.h"
+
+// The simple_repeater firmware, compiled into its own namespace so it can share the process with the
+// companion_radio's MyMesh. Everything it #includes is already pulled in above, so the headers' '#pragma once'
+// keeps them out of the namespace.
+namespace repeater {
+  #include "../simple_repeater/MyMesh.h"
+  #include "../simple_repeater/MyMesh.cpp"
+}
+
+class RepeaterNode : public SimNode {
+  repeater::MyMesh _mesh;
+
+public:
+  RepeaterNode(const char* name, SimClock& clock, uint32_t seed, uint32_t epoch)
+    : SimNode(name, clock, seed, epoch), _mesh(board, radio, clock, rng, rtc, tables) { }
+
+  const char* getType() const override { return "repeater"; }
+  mesh::Mesh& getMesh() override { return _mesh; }
+
+  void begin() override {
+    radio_init();
+    _mesh.self_id = radio_new_identity();
+    while (_mesh.self_id.pub_key[0] == 0x00 || _mesh.self_id.pub_key[0] == 0xFF) {  // reserved id hashes
+      _mesh.self_id = radio_new_identity();
+    }
+    StrHelper::strncpy(_mesh.getNodePrefs()->node_name, _name, sizeof(_mesh.getNodePrefs()->node_name));
+    _mesh.begin(&fs);
+    _mesh.sendSelfAdvertisement(16000);
+  }
+
+  void loop() override { _mesh.loop(); }
+
+  void handleCommand(char* command, char* reply) override {
+    _mesh.handleCommand(0, command, reply);
+  }
+};
+
+SimNode* createRepeaterNode(const char* name, SimClock& clock, uint32_t seed, uint32_t epoch) {
+  return new RepeaterNode(name, clock, seed, epoch);
+}
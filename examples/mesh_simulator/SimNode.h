@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Mesh.h>
+#include <helpers/SimpleMeshTables.h>
+#include <helpers/TxtDataHelpers.h>
+#include <target.h>
+
+/**
+ * \brief  One simulated device: its own radio, RNG, RTC, filesystem and mesh tables, plus the firmware's MyMesh.
+ *         All nodes share the network's SimClock.
+ */
+class SimNode {
+protected:
+  char _name[32];
+
+public:
+  SimRadio radio;
+  SimRNG rng;
+  SimRTCClock rtc;
+  RAMFileSystem fs;
+  SimpleMeshTables tables;
+
+  SimNode(const char* name, SimClock& clock, uint32_t seed, uint32_t epoch)
+    : radio(clock), rng(seed), rtc(clock, epoch), tables(&clock) {
+    StrHelper::strncpy(_name, name, sizeof(_name));
+  }
+  virtual ~SimNode() { }
+
+  const char* getName() const { return _name; }
+
+  /**
+   * \brief  makes this node's radio/RNG the target of the 'radio_driver' global, etc.  (call before any of the below)
+   */
+  void select() { sim_select_node(&radio, &rng); }
+
+  virtual const char* getType() const = 0;
+  virtual mesh::Mesh& getMesh() = 0;
+  virtual void begin() = 0;
+  virtual void loop() = 0;
+
+  /**
+   * \brief  run a scenario command on this node. (repeaters take the normal CLI commands)
+   * \param  reply  receives any text response
+   */
+  virtual void handleCommand(char* command, char* reply) = 0;
+
+  /**
+   * \brief  print any firmware specific stats (eg. message delivery), or nothing
+   */
+  virtual void printStats(Stream& out) { }
+};
+
+SimNode* createRepeaterNode(const char* name, SimClock& clock, uint32_t seed, uint32_t epoch);
+SimNode* createCompanionNode(const char* name, SimClock& clock, uint32_t seed, uint32_t epoch);
+
+/**
+ * \returns  the node with given name, or NULL  (implemented by main.cpp, so companions can address each other by name)
+ */
+SimNode* findSimNode(const char* name);
@@ -0,0 +1,286 @@
+/*
+ * Discrete-event mesh simulator.
+ *
+ * Runs many simple_repeater and companion_radio nodes in one process, against a virtual millisecond clock, with
+ * an explicit link table (per-pair SNR and loss) deciding who can hear whom. See SimNetwork for the radio model.
+ *
+ *   usage:  program {scenario-file} [-s seed] [-t tick-millis]
+ *
+ * Scenario file commands (one per line, '#' for comments, times in seconds):
+ *   node {name} repeater|companion
+ *   link {a} {b} {snr} [loss]                 two-way link, loss is probability 0..1
+ *   link1 {a} {b} {snr} [loss]                one-way link, a -> b
+ *   grid {prefix} {cols} {rows} repeater|companion {snr} [loss]
+ *                                             nodes {prefix}{x}.{y}, each linked to its 4 neighbours
+ *   scatter {prefix} {count} repeater|companion {size} {range}
+ *                                             nodes placed at random in a {size} x {size} square, linked to any
+ *                                             (earlier) scattered nodes within {range}, SNR falling linearly from
+ *                                             +10 (at 0) to -15 (at range)
+ *   at {secs} {node} {command...}             schedule a node command (repeater CLI, or companion: advert,
+ *                                             advert.zerohop, msg {dest} {text}, chan {text}, login {dest} {pw},
+ *                                             contacts.fill {count}, contacts.sync {app-ver})
+ *   run {secs}                                advance the simulation, then print summary
+ *   stats                                     print per-node stats
+ */
+#include <Arduino.h>
+#include <Mesh.h>
+#include "SimNode.h"
+#include <map>
+#include <string>
+#include <vector>
+
+#define SIM_EPOCH  1735689600   // 1 Jan 2025, start time for all node RTCs
+
+static SimClock sim_clock;
+static SimNetwork* network;
+static std::vector<SimNode*> nodes;
+static std::map<std::string, int> node_idx;
+
+struct ScheduledCmd {
+  int node;
+  std::string command;
+};
+static std::multimap<unsigned long, ScheduledCmd> schedule;
+
+struct ScatterPos {
+  int id;
+  float x, y;
+};
+static std::vector<ScatterPos> scattered;
+
+static unsigned long simMillis() {
+  return sim_clock.getMillis();
+}
+
+SimNode* findSimNode(const char* name) {
+  auto it = node_idx.find(name);
+  return it == node_idx.end() ? NULL : nodes[it->second];
+}
+
+static int addNode(const char* name, const char* type, uint32_t seed) {
+  if (node_idx.find(name) != node_idx.end()) {
+    Serial.printf("ERROR: duplicate node name: %s\n", name);
+    exit(1);
+  }
+  SimNode* node;
+  uint32_t node_seed = seed * 7919 + nodes.size() + 1;
+  if (strcmp(type, "repeater") == 0) {
+    node = createRepeaterNode(name, sim_clock, node_seed, SIM_EPOCH);
+  } else if (strcmp(type, "companion") == 0) {
+    node = createCompanionNode(name, sim_clock, node_seed, SIM_EPOCH);
+  } else {
+    Serial.printf("ERROR: unknown node type: %s\n", type);
+    exit(1);
+  }
+  int idx = network->addRadio(node->radio);
+  nodes.push_back(node);
+  node_idx[name] = idx;
+
+  node->select();
+  node->begin();
+  return idx;
+}
+
+static int getNodeIdx(const char* name) {
+  auto it = node_idx.find(name);
+  if (it == node_idx.end()) {
+    Serial.printf("ERROR: unknown node: %s\n", name);
+    exit(1);
+  }
+  return it->second;
+}
+
+static void runCommand(SimNode* node, const char* command) {
+  char cmd[160], reply[160];
+  StrHelper::strncpy(cmd, command, sizeof(cmd));
+  reply[0] = 0;
+  node->select();
+  node->handleCommand(cmd, reply);
+  if (reply[0]) {
+    Serial.printf("%8lu %s: %s  -> %s\n", sim_clock.getMillis(), node->getName(), command, reply);
+  }
+}
+
+static void runUntil(unsigned long end, int tick) {
+  for (unsigned long t = sim_clock.getMillis(); (long)(end - t) > 0; ) {
+    t += tick;
+    sim_clock.setMillis(t);
+    network->update();
+
+    while (!schedule.empty() && (long)(t - schedule.begin()->first) >= 0) {
+      auto it = schedule.begin();
+      runCommand(nodes[it->second.node], it->second.command.c_str());
+      schedule.erase(it);
+    }
+
+    for (auto node : nodes) {
+      node->select();
+      node->loop();
+    }
+  }
+}
+
+static void printSummary() {
+  uint32_t sent_flood = 0, sent_direct = 0, recv_flood = 0, recv_direct = 0;
+  unsigned long air_time = 0;
+  for (auto node : nodes) {
+    mesh::Mesh& m = node->getMesh();
+    sent_flood += m.getNumSentFlood(); sent_direct += m.getNumSentDirect();
+    recv_flood += m.getNumRecvFlood(); recv_direct += m.getNumRecvDirect();
+    air_time += m.getTotalAirTime();
+  }
+  unsigned long now = sim_clock.getMillis();
+  Serial.printf("--- at %lu.%03lu secs, %d nodes ---\n", now / 1000, now % 1000, (int)nodes.size());
+  Serial.printf("  air: transmits=%u delivered=%u lost=%u below_floor=%u collisions=%u half_duplex=%u rx_full=%u\n",
+    network->n_transmits, network->n_delivered, network->n_lost, network->n_below_floor,
+    network->n_collisions, network->n_half_duplex, network->n_rx_full);
+  Serial.printf("  mesh: sent(flood=%u direct=%u) recv(flood=%u direct=%u) total_air_time=%lu.%03lu secs\n",
+    sent_flood, sent_direct, recv_flood, recv_direct, air_time / 1000, air_time % 1000);
+  if (now > 0 && nodes.size() > 0) {
+    Serial.printf("  mean duty cycle: %.2f%%\n", 100.0 * air_time / now / nodes.size());
+  }
+}
+
+static void printNodeStats() {
+  for (auto node : nodes) {
+    mesh::Mesh& m = node->getMesh();
+    Serial.printf("  %-16s %-9s sent(flood=%u direct=%u) recv(flood=%u direct=%u) air=%lums dropped=%u",
+      node->getName(), node->getType(), m.getNumSentFlood(), m.getNumSentDirect(),
+      m.getNumRecvFlood(), m.getNumRecvDirect(), m.getTotalAirTime(), node->radio.getPacketsDropped());
+    Serial.printf(" dups(flood=%u direct=%u) evicted_early=%u",
+      node->tables.getNumFloodDups(), node->tables.getNumDirectDups(), node->tables.getNumEvictedEarly());
+#if MESH_ADVERT_BATCH_SIZE > 1
+    if (m.getNumAdvertBatches() > 0) {
+      Serial.printf(" advert_batches=%u (failed=%u)", m.getNumAdvertBatches(), m.getNumAdvertBatchFails());
+    }
+#endif
+    if (m.getNumPeerCollisions() > 0 || m.getNumPeerMACFails() > 0) {
+      Serial.printf(" peer_collisions=%u (mac_fails=%u)", m.getNumPeerCollisions(), m.getNumPeerMACFails());
+    }
+    node->printStats(Serial);
+    Serial.println();
+  }
+}
+
+static float parseFloat(const char* s, float def) {
+  return s ? atof(s) : def;
+}
+
+static void parseLine(char* line, int line_no, uint32_t seed, int tick) {
+  std::string orig = line;   // tokenising below only overwrites separators, so offsets still match
+  char* argv[16];
+  int argc = 0;
+  char* sp = line;
+  while (*sp && argc < 16) {
+    while (*sp == ' ' || *sp == '\t') sp++;
+    if (*sp == 0 || *sp == '#') break;
+    argv[argc++] = sp;
+    while (*sp && *sp != ' ' && *sp != '\t') sp++;
+    if (*sp) *sp++ = 0;
+  }
+  if (argc == 0) return;
+  const char* cmd = argv[0];
+
+  if (strcmp(cmd, "node") == 0 && argc >= 3) {
+    addNode(argv[1], argv[2], seed);
+  } else if ((strcmp(cmd, "link") == 0 || strcmp(cmd, "link1") == 0) && argc >= 4) {
+    int a = getNodeIdx(argv[1]), b = getNodeIdx(argv[2]);
+    float snr = atof(argv[3]);
+    float loss = parseFloat(argc > 4 ? argv[4] : NULL, 0.0f);
+    network->setLink(a, b, snr, loss);
+    if (cmd[4] == 0) network->setLink(b, a, snr, loss);
+  } else if (strcmp(cmd, "grid") == 0 && argc >= 6) {
+    int cols = atoi(argv[2]), rows = atoi(argv[3]);
+    float snr = atof(argv[5]);
+    float loss = parseFloat(argc > 6 ? argv[6] : NULL, 0.0f);
+    std::vector<int> ids;
+    char name[32];
+    for (int y = 0; y < rows; y++) {
+      for (int x = 0; x < cols; x++) {
+        snprintf(name, sizeof(name), "%s%d.%d", argv[1], x, y);
+        ids.push_back(addNode(name, argv[4], seed));
+      }
+    }
+    for (int y = 0; y < rows; y++) {
+      for (int x = 0; x < cols; x++) {
+        int a = ids[y*cols + x];
+        if (x + 1 < cols) { network->setLink(a, ids[y*cols + x + 1], snr, loss); network->setLink(ids[y*cols + x + 1], a, snr, loss); }
+        if (y + 1 < rows) { network->setLink(a, ids[(y + 1)*cols + x], snr, loss); network->setLink(ids[(y + 1)*cols + x], a, snr, loss); }
+      }
+    }
+  } else if (strcmp(cmd, "scatter") == 0 && argc >= 6) {
+    int count = atoi(argv[2]);
+    float size = atof(argv[4]), range = atof(argv[5]);
+    SimRNG place_rng(seed * 31 + nodes.size() + 1);
+    char name[32];
+    for (int i = 0; i < count; i++) {
+      snprintf(name, sizeof(name), "%s%d", argv[1], i);
+      ScatterPos p;
+      p.id = addNode(name, argv[3], seed);
+      p.x = size * (place_rng.next() % 10000) / 10000.0f;
+      p.y = size * (place_rng.next() % 10000) / 10000.0f;
+      for (auto& q : scattered) {   // link to all previously scattered nodes in range
+        float d = sqrtf((p.x - q.x)*(p.x - q.x) + (p.y - q.y)*(p.y - q.y));
+        if (d < range) {
+          float snr = 10.0f - 25.0f * d / range;
+          network->setLink(p.id, q.id, snr);
+          network->setLink(q.id, p.id, snr);
+        }
+      }
+      scattered.push_back(p);
+    }
+  } else if (strcmp(cmd, "at") == 0 && argc >= 4) {
+    ScheduledCmd s;
+    s.node = getNodeIdx(argv[2]);
+    s.command = orig.substr(argv[3] - line);   // rest of line
+    schedule.insert(std::make_pair((unsigned long)(atof(argv[1]) * 1000), s));
+  } else if (strcmp(cmd, "run") == 0 && argc >= 2) {
+    runUntil(sim_clock.getMillis() + (unsigned long)(atof(argv[1]) * 1000), tick);
+    printSummary();
+  } else if (strcmp(cmd, "stats") == 0) {
+    printNodeStats();
+  } else {
+    Serial.printf("ERROR: bad command at line %d: %s\n", line_no, cmd);
+    exit(1);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  const char* scenario = NULL;
+  uint32_t seed = 1;
+  int tick = 1;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      seed = atol(argv[++i]);
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      tick = max(1, atoi(argv[++i]));
+    } else {
+      scenario = argv[i];
+    }
+  }
+  if (scenario == NULL) {
+    fprintf(stderr, "usage: %s {scenario-file} [-s seed] [-t tick-millis]\n", argv[0]);
+    return 1;
+  }
+  FILE* f = fopen(scenario, "r");
+  if (f == NULL) {
+    fprintf(stderr, "can't open: %s\n", scenario);
+    return 1;
+  }
+
+  setMillisSource(simMillis);
+  randomSeed(seed);
+  network = new SimNetwork(sim_clock, seed);
+
+  char line[256];
+  int line_no = 0;
+  while (fgets(line, sizeof(line), f)) {
+    line_no++;
+    line[strcspn(line, "\r\n")] = 0;
+    parseLine(line, line_no, seed, tick);
+  }
+  fclose(f);
+  return 0;
+}
@@ -0,0 +1,240 @@
+#include <Arduino.h>   // needed for PlatformIO
+#include <Mesh.h>
+#include <helpers/StaticPoolPacketManager.h>
+#include <helpers/CompactPacketManager.h>
+
+/*
+ * Checks, then times, the packet queues against the original linear-scan PacketQueue (kept below as a reference).
+ * The 'idle tick' case is what Dispatcher::checkSend() costs every loop while packets wait for their scheduled time.
+ * Then measures how many queued packets fit per KB, with StaticPoolPacketManager vs CompactPacketManager's arena.
+ *    pio run -e linux_native_packet_manager_benchmark && .pio/build/linux_native_packet_manager_benchmark/program
+ */
+
+#define BENCH_MILLIS   500    // run each test for (at least) this long
+#define MAX_ENTRIES    256
+
+// the original PacketQueue: parallel tables, scanned on every call, shifted down on removal
+class LinearQueue {
+  mesh::Packet** _table;
+  uint8_t* _pri_table;
+  uint32_t* _schedule_table;
+  int _size, _num;
+
+public:
+  LinearQueue(int max_entries) {
+    _table = new mesh::Packet*[max_entries];
+    _pri_table = new uint8_t[max_entries];
+    _schedule_table = new uint32_t[max_entries];
+    _size = max_entries;
+    _num = 0;
+  }
+
+  int count() const { return _num; }
+
+  int countBefore(uint32_t now) const {
+    int n = 0;
+    for (int j = 0; j < _num; j++) {
+      if (_schedule_table[j] <= now) n++;
+    }
+    return n;
+  }
+
+  mesh::Packet* removeByIdx(int i) {
+    if (i >= _num) return NULL;
+
+    mesh::Packet* item = _table[i];
+    _num--;
+    while (i < _num) {
+      _table[i] = _table[i+1];
+      _pri_table[i] = _pri_table[i+1];
+      _schedule_table[i] = _schedule_table[i+1];
+      i++;
+    }
+    return item;
+  }
+
+  mesh::Packet* get(uint32_t now) {
+    uint8_t min_pri = 0xFF;
+    int best_idx = -1;
+    for (int j = 0; j < _num; j++) {
+      if (_schedule_table[j] > now) continue;
+      if (_pri_table[j] < min_pri) {
+        min_pri = _pri_table[j];
+        best_idx = j;
+      }
+    }
+    return best_idx < 0 ? NULL : removeByIdx(best_idx);
+  }
+
+  bool add(mesh::Packet* packet, uint8_t priority, uint32_t scheduled_for) {
+    if (_num == _size) return false;
+    _table[_num] = packet;
+    _pri_table[_num] = priority;
+    _schedule_table[_num] = scheduled_for;
+    _num++;
+    return true;
+  }
+};
+
+static mesh::Packet packets[MAX_ENTRIES];
+
+// random add/get/countBefore sequences must give identical results
+static bool checkSameOrder() {
+  PacketQueue q(MAX_ENTRIES);
+  LinearQueue ref(MAX_ENTRIES);
+  uint32_t now = 1000;
+  int next = 0;
+  for (int step = 0; step < 200000; step++) {
+    int r = random(100);
+    if (r < 45) {
+      mesh::Packet* pkt = &packets[next++ % MAX_ENTRIES];
+      uint8_t pri = random(4);
+      uint32_t when = now + random(3) * random(500);   // (lots of ties, in both priority and time)
+      if (q.add(pkt, pri, when) != ref.add(pkt, pri, when)) return false;
+    } else if (r < 90) {
+      if (q.get(now) != ref.get(now)) return false;
+    } else {
+      now += random(300);
+    }
+    if (q.count() != ref.count() || q.countBefore(now) != ref.countBefore(now)) return false;
+  }
+  return true;
+}
+
+static void report(const char* name, int num_entries, uint32_t count, unsigned long elapsed_micros) {
+  Serial.printf("  %-24s %3d entries  %8.1f ns/op\n", name, num_entries, elapsed_micros * 1000.0f / count);
+}
+
+#define BENCH(name, num_entries, op)  do { \
+    uint32_t n = 0; \
+    unsigned long start = micros(), elapsed; \
+    do { \
+      for (int i = 0; i < 64; i++) { op; } \
+      n += 64; \
+      elapsed = micros() - start; \
+    } while (elapsed < BENCH_MILLIS*1000UL); \
+    report(name, num_entries, n, elapsed); \
+  } while (0)
+
+template <class Q>
+static void benchQueue(const char* label, int num_entries) {
+  Q q(MAX_ENTRIES);
+  char name[32];
+  uint32_t now = 1000;
+
+  // all waiting on their scheduled time, so each loop only asks 'anything due?'
+  for (int i = 0; i < num_entries; i++) q.add(&packets[i], i % 4, now + 1000 + i*10);
+  snprintf(name, sizeof(name), "%s idle tick", label);
+  volatile int sink;
+  BENCH(name, num_entries, sink = q.countBefore(now); (void) sink);
+
+  // steady state: one packet due and sent per tick, one more queued
+  for (int i = 0; i < num_entries; i++) q.get(0xFFFFFFFF);
+  for (int i = 0; i < num_entries; i++) q.add(&packets[i], i % 4, now + i);
+  snprintf(name, sizeof(name), "%s add+get", label);
+  int k = 0;
+  BENCH(name, num_entries,
+    mesh::Packet* pkt = q.get(now); now++; q.add(pkt ? pkt : &packets[0], (k++) % 4, now + num_entries));
+}
+
+// a typical mix: 40% ACKs, 50% text messages and adverts, 10% other short packets (eg. path returns, requests)
+static void makeMixPacket(mesh::Packet* pkt) {
+  int r = random(100);
+  int payload_type, payload_len;
+  if (r < 40) {
+    payload_type = PAYLOAD_TYPE_ACK; payload_len = 4;
+  } else if (r < 65) {
+    payload_type = PAYLOAD_TYPE_TXT_MSG; payload_len = 4 + 16*random(1, 6);   // hashes, MAC, 1..5 cipher blocks
+  } else if (r < 90) {
+    payload_type = PAYLOAD_TYPE_ADVERT; payload_len = random(101, 122);   // pub_key, timestamp, signature, app_data
+  } else {
+    payload_type = PAYLOAD_TYPE_PATH; payload_len = 4 + 16;
+  }
+  pkt->header = (payload_type << PH_TYPE_SHIFT) | (random(2) ? ROUTE_TYPE_FLOOD : ROUTE_TYPE_DIRECT);
+  pkt->path_len = random(0, 7);
+  pkt->payload_len = payload_len;
+  memset(pkt->path, 0x5A, pkt->path_len);
+  memset(pkt->payload, 0xA5, payload_len);
+}
+
+// layout of a ScheduledQueue entry (private to it), for the per packet overhead of the queue
+template <typename T>
+struct QueueEntrySize { T item; uint32_t scheduled_for, seq; uint8_t priority; };
+
+static void measurePacketsPerKB() {
+  int static_bytes = sizeof(mesh::Packet) + sizeof(QueueEntrySize<mesh::Packet*>);
+  Serial.printf("  %-34s %4d bytes/packet  %5.1f packets/KB\n", "StaticPoolPacketManager", static_bytes,
+    1024.0f / static_bytes);
+
+  const int pages = 16;
+  PacketArena arena(pages);
+  uint16_t handles[pages * PACKET_ARENA_PAGE_SIZE / PACKET_ARENA_UNIT_SIZE];
+  int num = 0;
+  mesh::Packet pkt;
+
+  // fill from empty
+  for (;;) {
+    makeMixPacket(&pkt);
+    uint16_t h = arena.store(&pkt);
+    if (h == 0) break;
+    handles[num++] = h;
+  }
+  float kb = arena.getCapacityBytes() / 1024.0f;
+  Serial.printf("  %-34s %4.0f bytes/packet  %5.1f packets/KB\n", "PacketArena (filled from empty)",
+    arena.getCapacityBytes() / (float) num, num / kb);
+
+  // steady state: release a random half, refill until full, repeat (so blocks get fragmented, as in use)
+  long total = 0;
+  const int rounds = 200;
+  for (int r = 0; r < rounds; r++) {
+    for (int i = num - 1; i >= 0; i--) {
+      if (random(2)) {
+        arena.release(handles[i]);
+        handles[i] = handles[--num];
+      }
+    }
+    for (;;) {
+      makeMixPacket(&pkt);
+      uint16_t h = arena.store(&pkt);
+      if (h == 0) break;
+      handles[num++] = h;
+    }
+    total += num;
+  }
+  float avg = total / (float) rounds;
+  Serial.printf("  %-34s %4.0f bytes/packet  %5.1f packets/KB\n", "PacketArena (after churn)",
+    arena.getCapacityBytes() / avg, avg / kb);
+  Serial.printf("  %-34s %4d bytes/packet (queue entry, on top of arena)\n", "CompactPacketManager",
+    (int) sizeof(QueueEntrySize<uint16_t>));
+
+  for (int i = 0; i < num; i++) arena.release(handles[i]);
+  if (arena.getNumStored() != 0 || arena.getBytesUsed() != 0) Serial.println("FAIL: PacketArena did not empty");
+}
+
+void setup() {
+  Serial.begin(115200);
+  delay(1000);
+
+  if (!checkSameOrder()) {
+    Serial.println("FAIL: PacketQueue order differs from reference, not benchmarking");
+    return;
+  }
+  Serial.println("PacketQueue order OK");
+
+  static const int sizes[] = { 16, 32, 256 };
+  for (int i = 0; i < 3; i++) {
+    benchQueue<LinearQueue>("linear", sizes[i]);
+    benchQueue<PacketQueue>("PacketQueue", sizes[i]);
+  }
+
+  Serial.printf("packets per KB (sizeof(void*) = %d):\n", (int) sizeof(void*));
+  measurePacketsPerKB();
+
+  Serial.println("done");
+#if defined(LINUX_PLATFORM)
+  exit(0);
+#endif
+}
+
+void loop() {
+}
@@ -423,13 +423,7 @@ void MyMesh::onAnonDataRecv(mesh::Packet *packet, const uint8_t *secret, const m
 }
 
 int MyMesh::searchPeersByHash(const uint8_t *hash) {
-  int n = 0;
-  for (int i = 0; i < acl.getNumClients(); i++) {
-    if (acl.getClientByIdx(i)->id.isHashMatch(hash)) {
-      matching_peer_indexes[n++] = i; // store the INDEXES of matching contacts (for subsequent 'peer' methods)
-    }
-  }
-  return n;
+  return acl.searchByHash(hash, matching_peer_indexes, MAX_CLIENTS);  // store the INDEXES of matching clients (for subsequent 'peer' methods)
 }
 
 void MyMesh::getPeerSharedSecret(uint8_t *dest_secret, int peer_idx) {
@@ -579,7 +573,11 @@ bool MyMesh::onPeerPathRecv(mesh::Packet *packet, int sender_idx, const uint8_t
 
 MyMesh::MyMesh(mesh::MainBoard &board, mesh::Radio &radio, mesh::MillisecondClock &ms, mesh::RNG &rng,
                mesh::RTCClock &rtc, mesh::MeshTables &tables)
+#if defined(PACKET_ARENA_PAGES)
+    : mesh::Mesh(radio, ms, rng, rtc, *new CompactPacketManager(PACKET_ARENA_PAGES, 8), tables),
+#else
     : mesh::Mesh(radio, ms, rng, rtc, *new StaticPoolPacketManager(32), tables),
+#endif
       _cli(board, rtc, &_prefs, this), telemetry(MAX_PACKET_PAYLOAD - 4)
 #if defined(WITH_RS232_BRIDGE)
       , bridge(WITH_RS232_BRIDGE, _mgr, &rtc)
@@ -652,6 +650,8 @@ bool MyMesh::formatFileSystem() {
   return LittleFS.format();
 #elif defined(ESP32)
   return SPIFFS.format();
+#elif defined(LINUX_PLATFORM)
+  return RAMFS.format();
 #else
 #error "need to implement file system erase"
   return false;
@@ -766,6 +766,8 @@ void MyMesh::saveIdentity(const mesh::LocalIdentity &new_id) {
   IdentityStore store(*_fs, "/identity");
 #elif defined(RP2040_PLATFORM)
   IdentityStore store(*_fs, "/identity");
+#elif defined(LINUX_PLATFORM)
+  IdentityStore store(*_fs, "/identity");
 #else
 #error "need to define saveIdentity()"
 #endif
@@ -54,6 +54,10 @@ void setup() {
   fs = &LittleFS;
   IdentityStore store(LittleFS, "/identity");
   store.begin();
+#elif defined(LINUX_PLATFORM)
+  RAMFS.begin();
+  fs = &RAMFS;
+  IdentityStore store(RAMFS, "/identity");
 #else
   #error "need to define filesystem"
 #endif
@@ -364,13 +364,7 @@ void MyMesh::onAnonDataRecv(mesh::Packet *packet, const uint8_t *secret, const m
 }
 
 int MyMesh::searchPeersByHash(const uint8_t *hash) {
-  int n = 0;
-  for (int i = 0; i < acl.getNumClients(); i++) {
-    if (acl.getClientByIdx(i)->id.isHashMatch(hash)) {
-      matching_peer_indexes[n++] = i; // store the INDEXES of matching contacts (for subsequent 'peer' methods)
-    }
-  }
-  return n;
+  return acl.searchByHash(hash, matching_peer_indexes, MAX_CLIENTS);  // store the INDEXES of matching clients (for subsequent 'peer' methods)
 }
 
 void MyMesh::getPeerSharedSecret(uint8_t *dest_secret, int peer_idx) {
@@ -651,6 +645,8 @@ bool MyMesh::formatFileSystem() {
   return LittleFS.format();
 #elif defined(ESP32)
   return SPIFFS.format();
+#elif defined(LINUX_PLATFORM)
+  return RAMFS.format();
 #else
 #error "need to implement file system erase"
   return false;
@@ -709,6 +705,8 @@ void MyMesh::saveIdentity(const mesh::LocalIdentity &new_id) {
   IdentityStore store(*_fs, "/identity");
 #elif defined(RP2040_PLATFORM)
   IdentityStore store(*_fs, "/identity");
+#elif defined(LINUX_PLATFORM)
+  IdentityStore store(*_fs, "/identity");
 #else
 #error "need to define saveIdentity()"
 #endif
@@ -145,6 +145,7 @@ protected:
   void onAnonDataRecv(mesh::Packet* packet, const uint8_t* secret, const mesh::Identity& sender, uint8_t* data, size_t len) override;
   int searchPeersByHash(const uint8_t* hash) override ;
   void getPeerSharedSecret(uint8_t* dest_secret, int peer_idx) override;
+  bool getKnownSharedSecret(uint8_t* dest_secret, const mesh::Identity& peer) override { return acl.getSharedSecret(peer, dest_secret); }
   void onPeerDataRecv(mesh::Packet* packet, uint8_t type, int sender_idx, const uint8_t* secret, uint8_t* data, size_t len) override;
   bool onPeerPathRecv(mesh::Packet* packet, int sender_idx, const uint8_t* secret, uint8_t* path, uint8_t path_len, uint8_t extra_type, uint8_t* extra, uint8_t extra_len) override;
   void onAckRecv(mesh::Packet* packet, uint32_t ack_crc) override;
@@ -191,6 +192,7 @@ public:
 
   void saveIdentity(const mesh::LocalIdentity& new_id) override;
   void clearStats() override;
+  const mesh::LatencyStats* getLatencyStats() override { return mesh::Mesh::getLatencyStats(); }
   void handleCommand(uint32_t sender_timestamp, char* command, char* reply);
   void loop();
 };
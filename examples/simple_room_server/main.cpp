@@ -51,6 +51,10 @@ void setup() {
   SPIFFS.begin(true);
   fs = &SPIFFS;
   IdentityStore store(SPIFFS, "/identity");
+#elif defined(LINUX_PLATFORM)
+  RAMFS.begin();
+  fs = &RAMFS;
+  IdentityStore store(RAMFS, "/identity");
 #else
   #error "need to define filesystem"
 #endif
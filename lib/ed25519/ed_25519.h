@@ -4,6 +4,7 @@
 // Nightcracker's Ed25519 -  https://github.com/orlp/ed25519
 
 #include <stddef.h>
+#include "sha512.h"
 
 #if defined(_WIN32)
     #if defined(ED25519_BUILD_DLL)
@@ -22,6 +23,13 @@
 extern "C" {
 #endif
 
+/* state for ed25519_sign_init/update/final() */
+typedef struct {
+    sha512_context hram;
+    unsigned char r[64];
+    unsigned char R[32];
+} ed25519_sign_context;
+
 #ifndef ED25519_NO_SEED
 int ED25519_DECLSPEC ed25519_create_seed(unsigned char *seed);
 #endif
@@ -29,7 +37,11 @@ int ED25519_DECLSPEC ed25519_create_seed(unsigned char *seed);
 void ED25519_DECLSPEC ed25519_create_keypair(unsigned char *public_key, unsigned char *private_key, const unsigned char *seed);
 void ED25519_DECLSPEC ed25519_derive_pub(unsigned char *public_key, const unsigned char *private_key);
 void ED25519_DECLSPEC ed25519_sign(unsigned char *signature, const unsigned char *message, size_t message_len, const unsigned char *public_key, const unsigned char *private_key);
+void ED25519_DECLSPEC ed25519_sign_init(ed25519_sign_context *ctx, const unsigned char *public_key, const unsigned char *private_key, const unsigned char *entropy, size_t entropy_len);
+void ED25519_DECLSPEC ed25519_sign_update(ed25519_sign_context *ctx, const unsigned char *data, size_t len);
+void ED25519_DECLSPEC ed25519_sign_final(ed25519_sign_context *ctx, unsigned char *signature, const unsigned char *private_key);
 int ED25519_DECLSPEC ed25519_verify(const unsigned char *signature, const unsigned char *message, size_t message_len, const unsigned char *public_key);
+int ED25519_DECLSPEC ed25519_verify_batch(const unsigned char *const *signatures, const unsigned char *const *messages, const size_t *message_lens, const unsigned char *const *public_keys, const unsigned char *random_scalars, size_t count);
 void ED25519_DECLSPEC ed25519_add_scalar(unsigned char *public_key, unsigned char *private_key, const unsigned char *scalar);
 void ED25519_DECLSPEC ed25519_key_exchange(unsigned char *shared_secret, const unsigned char *public_key, const unsigned char *private_key);
 
@@ -0,0 +1,50 @@
+#include <string.h>
+#include "ed_25519.h"
+#include "sha512.h"
+#include "ge.h"
+#include "sc.h"
+
+/*
+Single pass signing, for messages fed in pieces. The deterministic nonce of
+ed25519_sign() is H(prefix || M), which needs M before R can be computed, and
+then again for H(R || A || M). So here the nonce is H(prefix || entropy)
+instead, and only H(R || A || M) is computed as the message is fed in. The
+signature is a standard one, checked by ed25519_verify().
+
+The entropy MUST differ for every signature, also across reboots (eg. RNG output
+plus a counter kept in flash, as a counter in RAM restarts from 0 at boot),
+as two messages signed with the same nonce reveal the private key.
+*/
+
+void ed25519_sign_init(ed25519_sign_context *ctx, const unsigned char *public_key, const unsigned char *private_key, const unsigned char *entropy, size_t entropy_len) {
+    sha512_context hash;
+    ge_p3 R;
+
+    sha512_init(&hash);
+    sha512_update(&hash, private_key + 32, 32);
+    sha512_update(&hash, entropy, entropy_len);
+    sha512_final(&hash, ctx->r);
+
+    sc_reduce(ctx->r);
+    ge_scalarmult_base(&R, ctx->r);
+    ge_p3_tobytes(ctx->R, &R);
+
+    sha512_init(&ctx->hram);
+    sha512_update(&ctx->hram, ctx->R, 32);
+    sha512_update(&ctx->hram, public_key, 32);
+}
+
+void ed25519_sign_update(ed25519_sign_context *ctx, const unsigned char *data, size_t len) {
+    sha512_update(&ctx->hram, data, len);
+}
+
+void ed25519_sign_final(ed25519_sign_context *ctx, unsigned char *signature, const unsigned char *private_key) {
+    unsigned char hram[64];
+
+    sha512_final(&ctx->hram, hram);
+    sc_reduce(hram);
+
+    memcpy(signature, ctx->R, 32);
+    sc_muladd(signature + 32, hram, private_key, ctx->r);
+    memset(ctx, 0, sizeof(*ctx));   /* nonce must not be reused */
+}
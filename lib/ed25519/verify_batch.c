@@ -0,0 +1,228 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ed_25519.h"
+#include "sha512.h"
+#include "ge.h"
+#include "sc.h"
+
+/*
+One term of the batch equation: a point P, its odd multiples P,3P,5P,7P and the
+signed sliding window digits of its scalar.
+*/
+
+typedef struct {
+    ge_cached Pi[4];
+    signed char digits[256];
+} batch_term;
+
+
+static int sc_is_canonical(const unsigned char *s) {
+    static const unsigned char L[32] = {
+        0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10
+    };
+    int i;
+
+    for (i = 31; i >= 0; --i) {
+        if (s[i] < L[i]) {
+            return 1;
+        }
+
+        if (s[i] > L[i]) {
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+
+/* as slide() in ge.c, but with digits limited to -7..7 (to halve the table of multiples) */
+static void slide7(signed char *r, const unsigned char *a) {
+    int i;
+    int b;
+    int k;
+
+    for (i = 0; i < 256; ++i) {
+        r[i] = 1 & (a[i >> 3] >> (i & 7));
+    }
+
+    for (i = 0; i < 256; ++i)
+        if (r[i]) {
+            for (b = 1; b <= 6 && i + b < 256; ++b) {
+                if (r[i + b]) {
+                    if (r[i] + (r[i + b] << b) <= 7) {
+                        r[i] += r[i + b] << b;
+                        r[i + b] = 0;
+                    } else if (r[i] - (r[i + b] << b) >= -7) {
+                        r[i] -= r[i + b] << b;
+
+                        for (k = i + b; k < 256; ++k) {
+                            if (!r[k]) {
+                                r[k] = 1;
+                                break;
+                            }
+
+                            r[k] = 0;
+                        }
+                    } else {
+                        break;
+                    }
+                }
+            }
+        }
+}
+
+
+static void batch_term_init(batch_term *term, const ge_p3 *P, const unsigned char *scalar) {
+    ge_p1p1 t;
+    ge_p3 u;
+    ge_p3 P2;
+    int i;
+
+    slide7(term->digits, scalar);
+    ge_p3_to_cached(&term->Pi[0], P);
+    ge_p3_dbl(&t, P);
+    ge_p1p1_to_p3(&P2, &t);
+
+    for (i = 1; i < 4; ++i) {
+        ge_add(&t, &P2, &term->Pi[i - 1]);
+        ge_p1p1_to_p3(&u, &t);
+        ge_p3_to_cached(&term->Pi[i], &u);
+    }
+}
+
+
+/*
+Checks all signatures at once, with the randomised (cofactored) batch equation:
+  8.((sum z_i.s_i).B - sum z_i.R_i - sum (z_i.h_i).A_i) == 0
+where z_i are the 128-bit random_scalars (16 bytes each), and h_i = H(R_i,A_i,M_i).
+Without the multiply by 8, a small order component in an R_i or A_i would make the
+result depend on the random z_i (ie. a batch could pass or fail by chance).
+Returns 1 only if the batch is valid. On 0 (or if out of memory) the signatures need
+checking individually, to find which are invalid.
+*/
+
+int ed25519_verify_batch(const unsigned char *const *signatures, const unsigned char *const *messages, const size_t *message_lens,
+                         const unsigned char *const *public_keys, const unsigned char *random_scalars, size_t count) {
+    unsigned char h[64];
+    unsigned char z[32];
+    unsigned char zh[32];
+    unsigned char zs[32];
+    unsigned char zero[32];
+    unsigned char checker[32];
+    sha512_context hash;
+    batch_term *terms;
+    ge_p1p1 t;
+    ge_p3 u;
+    ge_p3 P;
+    ge_p2 r;
+    ge_cached Bs;
+    size_t num_terms = count * 2;
+    size_t i;
+    size_t j;
+    int k;
+    int result = 0;
+
+    if (count == 0) {
+        return 1;
+    }
+
+    terms = (batch_term *) malloc(num_terms * sizeof(batch_term));
+
+    if (terms == NULL) {
+        return 0;
+    }
+
+    memset(zero, 0, 32);
+    memset(zs, 0, 32);
+    memset(z, 0, 32);
+
+    for (i = 0; i < count; ++i) {
+        const unsigned char *signature = signatures[i];
+
+        if (!sc_is_canonical(signature + 32)) {
+            goto done;
+        }
+
+        sha512_init(&hash);
+        sha512_update(&hash, signature, 32);
+        sha512_update(&hash, public_keys[i], 32);
+        sha512_update(&hash, messages[i], message_lens[i]);
+        sha512_final(&hash, h);
+        sc_reduce(h);
+
+        memcpy(z, random_scalars + i * 16, 16);
+        sc_muladd(zh, z, h, zero);
+        sc_muladd(zs, z, signature + 32, zs);
+
+        /* the decoded points are negated, giving the subtractions */
+        if (ge_frombytes_negate_vartime(&P, public_keys[i]) != 0) {
+            goto done;
+        }
+
+        batch_term_init(&terms[i * 2], &P, zh);
+
+        if (ge_frombytes_negate_vartime(&P, signature) != 0) {
+            goto done;
+        }
+
+        batch_term_init(&terms[i * 2 + 1], &P, z);
+    }
+
+    for (k = 255; k >= 0; --k) {
+        for (j = 0; j < num_terms && !terms[j].digits[k]; ++j);
+
+        if (j < num_terms) {
+            break;
+        }
+    }
+
+    ge_p3_0(&u);
+    ge_p2_0(&r);
+
+    for (; k >= 0; --k) {
+        ge_p2_dbl(&t, &r);
+
+        for (j = 0; j < num_terms; ++j) {
+            signed char d = terms[j].digits[k];
+
+            if (d > 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_add(&t, &u, &terms[j].Pi[d / 2]);
+            } else if (d < 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_sub(&t, &u, &terms[j].Pi[(-d) / 2]);
+            }
+        }
+
+        ge_p1p1_to_p2(&r, &t);
+
+        if (k == 0) {
+            ge_p1p1_to_p3(&u, &t);
+        }
+    }
+
+    ge_scalarmult_base(&P, zs);
+    ge_p3_to_cached(&Bs, &P);
+    ge_add(&t, &u, &Bs);
+
+    for (k = 0; k < 3; ++k) {   /* times the cofactor */
+        ge_p1p1_to_p2(&r, &t);
+        ge_p2_dbl(&t, &r);
+    }
+
+    ge_p1p1_to_p2(&r, &t);
+    ge_tobytes(checker, &r);
+
+    /* must be the neutral element, (0,1) */
+    checker[0] ^= 1;
+
+    for (k = 0; k < 32 && !checker[k]; ++k);
+
+    result = (k == 32);
+
+done:
+    free(terms);
+    return result;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Block cipher and hash implementations behind Utils and CipherContext, selected at build time, eg:
+ *    -D MESH_CRYPTO_BACKEND=MESH_CRYPTO_SOFT
+ *
+ * A backend provides, in namespace mesh:
+ *    CryptoAES128:  bool setKey(key, len), encryptBlocks(out, in, num_blocks), decryptBlocks(out, in, num_blocks)
+ *    CryptoSHA256:  reset(), update(data, len), finalize(hash, len)  -- and must be copy-assignable (see CipherContext)
+ *    MESH_CRYPTO_BACKEND_NAME
+ * To add an accelerated one for a board (eg. an AES peripheral), add a MESH_CRYPTO_xxx value, and a branch below.
+ * Check it with examples/crypto_benchmark, which checks against test vectors before timing.
+ */
+#define MESH_CRYPTO_RWEATHER   1    // rweather/Crypto library (table based AES)
+#define MESH_CRYPTO_SOFT       2    // SoftAES128 (constant-time, bitsliced), SoftSHA256
+
+#ifndef MESH_CRYPTO_BACKEND
+  #define MESH_CRYPTO_BACKEND   MESH_CRYPTO_RWEATHER
+#endif
+
+#if MESH_CRYPTO_BACKEND == MESH_CRYPTO_RWEATHER
+
+#include <AES.h>
+#include <SHA256.h>
+
+#define MESH_CRYPTO_BACKEND_NAME   "rweather"
+
+namespace mesh {
+
+class CryptoAES128 : public ::AES128 {
+public:
+  void encryptBlocks(uint8_t* out, const uint8_t* in, int num_blocks) {
+    for (int i = 0; i < num_blocks; i++) encryptBlock(&out[i*16], &in[i*16]);
+  }
+  void decryptBlocks(uint8_t* out, const uint8_t* in, int num_blocks) {
+    for (int i = 0; i < num_blocks; i++) decryptBlock(&out[i*16], &in[i*16]);
+  }
+};
+
+typedef ::SHA256 CryptoSHA256;
+
+}
+
+#elif MESH_CRYPTO_BACKEND == MESH_CRYPTO_SOFT
+
+#include "SoftCrypto.h"
+
+#define MESH_CRYPTO_BACKEND_NAME   "soft"
+
+namespace mesh {
+
+typedef SoftAES128 CryptoAES128;
+typedef SoftSHA256 CryptoSHA256;
+
+}
+
+#else
+  #error "unknown MESH_CRYPTO_BACKEND"
+#endif
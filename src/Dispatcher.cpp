@@ -74,6 +74,10 @@ void Dispatcher::loop() {
       } else {
         n_sent_direct++;
       }
+    #if MESH_LATENCY_STATS
+      _latency.record(outbound->getPayloadType(), LATENCY_STAGE_AIRTIME, t);
+      _latency.record(outbound->getPayloadType(), LATENCY_STAGE_TOTAL, _ms->getMillis() - outbound->_t_origin);
+    #endif
       releasePacket(outbound);  // return to pool
       outbound = NULL;
     } else if (millisHasNowPassed(outbound_expiry)) {
@@ -109,62 +113,58 @@ void Dispatcher::loop() {
 }
 
 void Dispatcher::checkRecv() {
-  Packet* pkt;
+  Packet* pkt = NULL;
   float score;
   uint32_t air_time;
-  {
-    uint8_t raw[MAX_TRANS_UNIT+1];
-    int len = _radio->recvRaw(raw, MAX_TRANS_UNIT);
-    if (len > 0) {
-      logRxRaw(_radio->getLastSNR(), _radio->getLastRSSI(), raw, len);
-
-      pkt = _mgr->allocNew();
-      if (pkt == NULL) {
-        MESH_DEBUG_PRINTLN("%s Dispatcher::checkRecv(): WARNING: received data, no unused packets available!", getLogDateTime());
-      } else {
-        int i = 0;
+
+  const uint8_t* raw = _raw;
+  int frame_len = _radio->recvRaw(_raw, MAX_TRANS_UNIT);
+  int len = frame_len;
+  if (len > 0) {
+    logRxRaw(_radio->getLastSNR(), _radio->getLastRSSI(), raw, len);
+
 #ifdef NODE_ID
-        uint8_t sender_id = raw[i++];
-        if (sender_id == NODE_ID - 1 || sender_id == NODE_ID + 1) {  // simulate that NODE_ID can only hear NODE_ID-1 or NODE_ID+1, eg. 3 can't hear 1
-        } else {
-          _mgr->free(pkt);  // put back into pool
-          return;
-        }
+    uint8_t sender_id = *raw++;  len--;
+    if (sender_id == NODE_ID - 1 || sender_id == NODE_ID + 1) {  // simulate that NODE_ID can only hear NODE_ID-1 or NODE_ID+1, eg. 3 can't hear 1
+    } else {
+      return;
+    }
 #endif
 
-        pkt->header = raw[i++];
-        if (pkt->hasTransportCodes()) {
-          memcpy(&pkt->transport_codes[0], &raw[i], 2); i += 2;
-          memcpy(&pkt->transport_codes[1], &raw[i], 2); i += 2;
-        } else {
-          pkt->transport_codes[0] = pkt->transport_codes[1] = 0;
-        }
-        pkt->path_len = raw[i++];
-
-        if (pkt->path_len > MAX_PATH_SIZE || i + pkt->path_len > len) {
-          MESH_DEBUG_PRINTLN("%s Dispatcher::checkRecv(): partial or corrupt packet received, len=%d", getLogDateTime(), len);
-          _mgr->free(pkt);  // put back into pool
-          pkt = NULL;
-        } else {
-          memcpy(pkt->path, &raw[i], pkt->path_len); i += pkt->path_len;
-
-          pkt->payload_len = len - i;  // payload is remainder
-          if (pkt->payload_len > sizeof(pkt->payload)) {
-            MESH_DEBUG_PRINTLN("%s Dispatcher::checkRecv(): packet payload too big, payload_len=%d", getLogDateTime(), (uint32_t)pkt->payload_len);
-            _mgr->free(pkt);  // put back into pool
-            pkt = NULL;  
-          } else {
-            memcpy(pkt->payload, &raw[i], pkt->payload_len);
-
-            pkt->_snr = _radio->getLastSNR() * 4.0f;
-            score = _radio->packetScore(_radio->getLastSNR(), len);
-            air_time = _radio->getEstAirtimeFor(len);
-            rx_air_time += air_time;
-          }
-        }
-      }
+    // validate the framing before taking a Packet from the pool
+    int i = 1;   // header
+    if (len > 0 && ((raw[0] & PH_ROUTE_MASK) == ROUTE_TYPE_TRANSPORT_FLOOD || (raw[0] & PH_ROUTE_MASK) == ROUTE_TYPE_TRANSPORT_DIRECT)) {
+      i += 4;   // transport codes
+    }
+    int path_len = i < len ? raw[i] : 0;
+    i++;
+    if (i > len || path_len > MAX_PATH_SIZE || i + path_len > len) {
+      MESH_DEBUG_PRINTLN("%s Dispatcher::checkRecv(): partial or corrupt packet received, len=%d", getLogDateTime(), len);
+    } else if (len - (i + path_len) > MAX_PACKET_PAYLOAD) {
+      MESH_DEBUG_PRINTLN("%s Dispatcher::checkRecv(): packet payload too big, payload_len=%d", getLogDateTime(), (uint32_t)(len - (i + path_len)));
+    } else if ((pkt = _mgr->allocNew()) == NULL) {
+      MESH_DEBUG_PRINTLN("%s Dispatcher::checkRecv(): WARNING: received data, no unused packets available!", getLogDateTime());
     } else {
-      pkt = NULL;
+      pkt->invalidateHash();
+      pkt->header = raw[0];
+      if (pkt->hasTransportCodes()) {
+        memcpy(&pkt->transport_codes[0], &raw[1], 2);
+        memcpy(&pkt->transport_codes[1], &raw[3], 2);
+      } else {
+        pkt->transport_codes[0] = pkt->transport_codes[1] = 0;
+      }
+      pkt->path_len = path_len;
+      memcpy(pkt->path, &raw[i], path_len); i += path_len;
+      pkt->payload_len = len - i;  // payload is remainder
+      memcpy(pkt->payload, &raw[i], pkt->payload_len);
+
+      pkt->_snr = _radio->getLastSNR() * 4.0f;
+    #if MESH_LATENCY_STATS
+      pkt->_t_origin = pkt->_t_queued = _ms->getMillis();
+    #endif
+      score = _radio->packetScore(_radio->getLastSNR(), frame_len);
+      air_time = _radio->getEstAirtimeFor(frame_len);
+      rx_air_time += air_time;
     }
   }
   if (pkt) {
@@ -210,7 +210,16 @@ void Dispatcher::checkRecv() {
 }
 
 void Dispatcher::processRecvPacket(Packet* pkt) {
+#if MESH_LATENCY_STATS
+  uint8_t type = pkt->getPayloadType();
+  unsigned long start = _ms->getMillis();
+  _latency.record(type, LATENCY_STAGE_RX_QUEUE, start - pkt->_t_queued);
+#endif
   DispatcherAction action = onRecvPacket(pkt);
+#if MESH_LATENCY_STATS
+  _latency.record(type, LATENCY_STAGE_PROCESS, _ms->getMillis() - start);
+  pkt->_t_queued = _ms->getMillis();   // for ACTION_RETRANSMIT
+#endif
   if (action == ACTION_RELEASE) {
     _mgr->free(pkt);
   } else if (action == ACTION_MANUAL_HOLD) {
@@ -246,26 +255,22 @@ void Dispatcher::checkSend() {
 
   outbound = _mgr->getNextOutbound(_ms->getMillis());
   if (outbound) {
+  #if MESH_LATENCY_STATS
+    _latency.record(outbound->getPayloadType(), LATENCY_STAGE_TX_QUEUE, _ms->getMillis() - outbound->_t_queued);
+  #endif
     int len = 0;
-    uint8_t raw[MAX_TRANS_UNIT];
+    uint8_t* raw = _raw;
 
 #ifdef NODE_ID
     raw[len++] = NODE_ID;
 #endif
-    raw[len++] = outbound->header;
-    if (outbound->hasTransportCodes()) {
-      memcpy(&raw[len], &outbound->transport_codes[0], 2); len += 2;
-      memcpy(&raw[len], &outbound->transport_codes[1], 2); len += 2;
-    }
-    raw[len++] = outbound->path_len;
-    memcpy(&raw[len], outbound->path, outbound->path_len); len += outbound->path_len;
-
-    if (len + outbound->payload_len > MAX_TRANS_UNIT) {
-      MESH_DEBUG_PRINTLN("%s Dispatcher::checkSend(): FATAL: Invalid packet queued... too long, len=%d", getLogDateTime(), len + outbound->payload_len);
+    if (outbound->path_len > MAX_PATH_SIZE || outbound->payload_len > MAX_PACKET_PAYLOAD
+        || len + outbound->getRawLength() > MAX_TRANS_UNIT) {
+      MESH_DEBUG_PRINTLN("%s Dispatcher::checkSend(): FATAL: Invalid packet queued... too long, len=%d", getLogDateTime(), len + outbound->getRawLength());
       _mgr->free(outbound);
       outbound = NULL;
     } else {
-      memcpy(&raw[len], outbound->payload, outbound->payload_len); len += outbound->payload_len;
+      len += outbound->writeTo(&raw[len]);   // serialise straight into the frame buffer
 
       uint32_t max_airtime = _radio->getEstAirtimeFor(len)*3/2;
       outbound_start = _ms->getMillis();
@@ -303,6 +308,10 @@ Packet* Dispatcher::obtainNewPacket() {
   } else {
     pkt->payload_len = pkt->path_len = 0;
     pkt->_snr = 0;
+    pkt->invalidateHash();
+  #if MESH_LATENCY_STATS
+    pkt->_t_origin = pkt->_t_queued = _ms->getMillis();
+  #endif
   }
   return pkt;
 }
@@ -316,6 +325,9 @@ void Dispatcher::sendPacket(Packet* packet, uint8_t priority, uint32_t delay_mil
     MESH_DEBUG_PRINTLN("%s Dispatcher::sendPacket(): ERROR: invalid packet... path_len=%d, payload_len=%d", getLogDateTime(), (uint32_t) packet->path_len, (uint32_t) packet->payload_len);
     _mgr->free(packet);
   } else {
+  #if MESH_LATENCY_STATS
+    packet->_t_queued = _ms->getMillis();
+  #endif
     _mgr->queueOutbound(packet, priority, futureMillis(delay_millis));
   }
 }
@@ -95,6 +95,48 @@ public:
   virtual Packet* removeOutboundByIdx(int i) = 0;
   virtual void queueInbound(Packet* packet, uint32_t scheduled_for) = 0;
   virtual Packet* getNextInbound(uint32_t now) = 0;
+  virtual int getInboundCount() const = 0;           // including those not yet due
+  virtual Packet* getInboundByIdx(int i) = 0;        // for peeking only (remains queued)
+};
+
+#define LATENCY_STAGE_RX_QUEUE    0    // radio RX -> onRecvPacket()  (ie. the flood score delay)
+#define LATENCY_STAGE_PROCESS     1    // time spent in onRecvPacket()
+#define LATENCY_STAGE_TX_QUEUE    2    // outbound queued -> TX start  (retransmit delay, airtime budget, CAD)
+#define LATENCY_STAGE_AIRTIME     3    // TX start -> TX complete
+#define LATENCY_STAGE_TOTAL       4    // radio RX (or first sendPacket()) -> TX complete
+#define LATENCY_NUM_STAGES        5
+#define LATENCY_NUM_BUCKETS       8    // upper bounds (millis): 4, 16, 64, 256, 1024, 4096, 16384, (unbounded)
+#define LATENCY_NUM_TYPES        16    // by payload type
+
+struct LatencyHistogram {
+  uint32_t count, total_millis, max_millis;
+  uint16_t buckets[LATENCY_NUM_BUCKETS];   // saturating counts
+
+  static uint32_t bucketLimit(int i) { return i < LATENCY_NUM_BUCKETS - 1 ? 4UL << (i*2) : 0xFFFFFFFF; }
+
+  void add(uint32_t millis) {
+    int b = 0;
+    while (millis >= bucketLimit(b)) b++;
+    if (buckets[b] < 0xFFFF) buckets[b]++;
+    count++;
+    total_millis += millis;
+    if (millis > max_millis) max_millis = millis;
+  }
+};
+
+/**
+ * \brief  Per payload type latency histograms, for each stage of the Dispatcher pipeline.
+ *         (only collected in builds with MESH_LATENCY_STATS=1)
+ */
+class LatencyStats {
+  LatencyHistogram _hist[LATENCY_NUM_TYPES][LATENCY_NUM_STAGES];
+
+public:
+  LatencyStats() { reset(); }
+
+  void reset() { memset(_hist, 0, sizeof(_hist)); }
+  void record(uint8_t payload_type, int stage, uint32_t millis) { _hist[payload_type & 0x0F][stage].add(millis); }
+  const LatencyHistogram& get(uint8_t payload_type, int stage) const { return _hist[payload_type & 0x0F][stage]; }
 };
 
 typedef uint32_t  DispatcherAction;
@@ -122,6 +164,10 @@ class Dispatcher {
   bool  prev_isrecv_mode;
   uint32_t n_sent_flood, n_sent_direct;
   uint32_t n_recv_flood, n_recv_direct;
+  uint8_t _raw[MAX_TRANS_UNIT+1];   // radio frame buffer, shared by checkRecv()/checkSend() (kept off the stack)
+#if MESH_LATENCY_STATS
+  LatencyStats _latency;
+#endif
 
   void processRecvPacket(Packet* pkt);
 
@@ -177,6 +223,20 @@ public:
   void resetStats() {
     n_sent_flood = n_sent_direct = n_recv_flood = n_recv_direct = 0;
     _err_flags = 0;
+  #if MESH_LATENCY_STATS
+    _latency.reset();
+  #endif
+  }
+
+  /**
+   * \returns  the pipeline latency histograms, or NULL if not built with MESH_LATENCY_STATS
+   */
+  const LatencyStats* getLatencyStats() const {
+  #if MESH_LATENCY_STATS
+    return &_latency;
+  #else
+    return NULL;
+  #endif
   }
 
   // helper methods
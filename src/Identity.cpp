@@ -23,6 +23,18 @@ bool Identity::verify(const uint8_t* sig, const uint8_t* message, int msg_len) c
 #endif
 }
 
+bool Identity::verifyBatch(const uint8_t* const sigs[], const uint8_t* const pub_keys[], const uint8_t* const messages[],
+                           const int msg_lens[], int count, RNG& rng) {
+  if (count > MAX_VERIFY_BATCH) return false;
+
+  uint8_t weights[MAX_VERIFY_BATCH*16];
+  size_t lens[MAX_VERIFY_BATCH];
+  rng.random(weights, count*16);
+  for (int i = 0; i < count; i++) lens[i] = msg_lens[i];
+
+  return ed25519_verify_batch(sigs, messages, lens, pub_keys, weights, count) == 1;
+}
+
 bool Identity::readFrom(Stream& s) {
   return (s.readBytes(pub_key, PUB_KEY_SIZE) == PUB_KEY_SIZE);
 }
@@ -92,6 +104,23 @@ void LocalIdentity::sign(uint8_t* sig, const uint8_t* message, int msg_len) cons
   ed25519_sign(sig, message, msg_len, pub_key, prv_key);
 }
 
+void LocalIdentity::signStart(SignContext& ctx, RNG& rng, const uint8_t* uniq, int uniq_len) const {
+  uint8_t entropy[32 + 32];
+  if (uniq_len > 32) uniq_len = 32;
+  rng.random(entropy, 32);
+  memcpy(&entropy[32], uniq, uniq_len);   // so nonce is fresh even if rng repeats, eg. same seed after a reboot
+  ed25519_sign_init(&ctx._state, pub_key, prv_key, entropy, 32 + uniq_len);
+  memset(entropy, 0, sizeof(entropy));
+}
+
+void LocalIdentity::signUpdate(SignContext& ctx, const uint8_t* data, int len) const {
+  ed25519_sign_update(&ctx._state, data, len);
+}
+
+void LocalIdentity::signFinish(SignContext& ctx, uint8_t* sig) const {
+  ed25519_sign_final(&ctx._state, sig, prv_key);
+}
+
 void LocalIdentity::calcSharedSecret(uint8_t* secret, const uint8_t* other_pub_key) const {
   ed25519_key_exchange(secret, other_pub_key, prv_key);
 }
@@ -2,6 +2,9 @@
 
 #include <Utils.h>
 #include <Stream.h>
+#include <ed_25519.h>
+
+#define MAX_VERIFY_BATCH   16
 
 namespace mesh {
 
@@ -33,6 +36,18 @@ public:
   */
   bool verify(const uint8_t* sig, const uint8_t* message, int msg_len) const;
 
+  /**
+   * \brief  Verifies a batch of Ed25519 signatures together (randomised batch verification), which is
+   *         considerably cheaper per signature than verify().
+   * \param  count  number of signatures, max MAX_VERIFY_BATCH
+   * \param  rng  source for the random per-signature weights
+   * \returns true, only if ALL signatures are valid. (if false, verify() each to find the culprits)
+   *          NOTE: uses the cofactored equation, so the result never depends on the random weights. A signature that
+   *          its key's owner crafted with a small order component can pass here, yet fail the (cofactorless) verify().
+  */
+  static bool verifyBatch(const uint8_t* const sigs[], const uint8_t* const pub_keys[], const uint8_t* const messages[],
+                          const int msg_lens[], int count, RNG& rng);
+
   bool matches(const Identity& other) const { return memcmp(pub_key, other.pub_key, PUB_KEY_SIZE) == 0; }
   bool matches(const uint8_t* other_pubkey) const { return memcmp(pub_key, other_pubkey, PUB_KEY_SIZE) == 0; }
 
@@ -41,11 +56,19 @@ public:
   void printTo(Stream& s) const;
 };
 
+/**
+ * \brief  State of an incremental signature, see LocalIdentity::signStart()
+*/
+class SignContext {
+  friend class LocalIdentity;
+  ed25519_sign_context _state;
+};
+
 /**
  * \brief  An Identity generated on THIS device, ie. with public/private Ed25519 key pair being on this device.
 */
 class LocalIdentity : public Identity {
-  uint8_t prv_key[PRV_KEY_SIZE];
+  uint8_t prv_key[PRV_KEY_SIZE];   // the expanded key (clamped scalar + nonce prefix), so signing never re-hashes the seed
 public:
   LocalIdentity();
   LocalIdentity(const char* prv_hex, const char* pub_hex);
@@ -59,6 +82,21 @@ public:
   */
   void sign(uint8_t* sig, const uint8_t* message, int msg_len) const;
 
+  /**
+   * \brief  Starts an Ed25519 signature of a message fed in pieces, with signUpdate(), so that large data need not be
+   *         held in RAM. Result verifies the same as sign(), but the nonce is from 'rng' and 'uniq', rather than
+   *         derived from the whole message (which would need two passes over it).
+   *         NOTE: a repeated nonce gives away the private key, and a board's RNG may well repeat after a reboot, so
+   *         'uniq' must NEVER repeat for this identity, even across reboots (eg. a counter saved to flash).
+  */
+  void signStart(SignContext& ctx, RNG& rng, const uint8_t* uniq, int uniq_len) const;
+  void signUpdate(SignContext& ctx, const uint8_t* data, int len) const;
+
+  /**
+   * \param sig OUT - must be SIGNATURE_SIZE buffer.
+  */
+  void signFinish(SignContext& ctx, uint8_t* sig) const;
+
   /**
    * \brief  the ECDH key exhange, with Ed25519 public key transposed to Ex25519.
    * \param  secret OUT - the 'shared secret' (must be PUB_KEY_SIZE bytes)
@@ -34,8 +34,29 @@ int Mesh::searchPeersByHash(const uint8_t* hash) {
   return 0;  // not found
 }
 
-int Mesh::searchChannelsByHash(const uint8_t* hash, GroupChannel channels[], int max_matches) {
-  return 0;  // not found
+// parses the advert in 'pkt' into the message that was signed.  returns the message length, or -1 if malformed
+static int getAdvertSignedMessage(const Packet* pkt, uint8_t* message, const uint8_t** signature) {
+  int i = PUB_KEY_SIZE + 4 + SIGNATURE_SIZE;
+  if (pkt->getPayloadType() != PAYLOAD_TYPE_ADVERT || i > pkt->payload_len) return -1;
+
+  int app_data_len = pkt->payload_len - i;
+  if (app_data_len > MAX_ADVERT_DATA_SIZE) { app_data_len = MAX_ADVERT_DATA_SIZE; }
+
+  memcpy(message, pkt->payload, PUB_KEY_SIZE + 4);   // pub_key, timestamp
+  memcpy(&message[PUB_KEY_SIZE + 4], &pkt->payload[i], app_data_len);
+  *signature = &pkt->payload[PUB_KEY_SIZE + 4];
+  return PUB_KEY_SIZE + 4 + app_data_len;
+}
+
+// SHA-256 of the advert's signature + signed message, ie. what identifies an advert that has been verified
+static bool getAdvertDigest(const Packet* pkt, uint8_t* digest) {
+  uint8_t message[PUB_KEY_SIZE + 4 + MAX_ADVERT_DATA_SIZE];
+  const uint8_t* signature;
+  int msg_len = getAdvertSignedMessage(pkt, message, &signature);
+  if (msg_len < 0) return false;
+
+  Utils::sha256(digest, 32, signature, SIGNATURE_SIZE, message, msg_len);
+  return true;
 }
 
 DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
@@ -122,37 +143,39 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
         // FUTURE: could send back multiple paths, using createPathReturn(), and let sender choose which to use(?)
 
         if (self_id.isHashMatch(&dest_hash)) {
-          // scan contacts DB, for all matching hashes of 'src_hash' (max 4 matches supported ATM)
+          // scan contacts DB, for all matching hashes of 'src_hash'
           int num = searchPeersByHash(&src_hash);
-          // for each matching contact, try to decrypt data
-          bool found = false;
-          for (int j = 0; j < num; j++) {
-            uint8_t secret[PUB_KEY_SIZE];
-            getPeerSharedSecret(secret, j);
+          if (num > 1) _n_peer_collisions++;
 
-            // decrypt, checking MAC is valid
+          // check MAC only, against each candidate, so that only the actual sender's data gets decrypted
+          uint8_t secret[PUB_KEY_SIZE];
+          int j = 0;
+          while (j < num) {
+            getPeerSharedSecret(secret, j);
+            if (getCipher(secret).verifyMAC(macAndData, pkt->payload_len - i)) break;
+            _n_peer_mac_fails++;
+            j++;
+          }
+          bool found = j < num;
+          if (found) {
             uint8_t data[MAX_PACKET_PAYLOAD];
-            int len = Utils::MACThenDecrypt(secret, data, macAndData, pkt->payload_len - i);
-            if (len > 0) {  // success!
-              if (pkt->getPayloadType() == PAYLOAD_TYPE_PATH) {
-                int k = 0;
-                uint8_t path_len = data[k++];
-                uint8_t* path = &data[k]; k += path_len;
-                uint8_t extra_type = data[k++] & 0x0F;   // upper 4 bits reserved for future use
-                uint8_t* extra = &data[k];
-                uint8_t extra_len = len - k;   // remainder of packet (may be padded with zeroes!)
-                if (onPeerPathRecv(pkt, j, secret, path, path_len, extra_type, extra, extra_len)) {
-                  if (pkt->isRouteFlood()) {
-                    // send a reciprocal return path to sender, but send DIRECTLY!
-                    mesh::Packet* rpath = createPathReturn(&src_hash, secret, pkt->path, pkt->path_len, 0, NULL, 0);
-                    if (rpath) sendDirect(rpath, path, path_len, 500);
-                  }
+            int len = getCipher(secret).decrypt(data, &macAndData[CIPHER_MAC_SIZE], pkt->payload_len - i - CIPHER_MAC_SIZE);
+            if (pkt->getPayloadType() == PAYLOAD_TYPE_PATH) {
+              int k = 0;
+              uint8_t path_len = data[k++];
+              uint8_t* path = &data[k]; k += path_len;
+              uint8_t extra_type = data[k++] & 0x0F;   // upper 4 bits reserved for future use
+              uint8_t* extra = &data[k];
+              uint8_t extra_len = len - k;   // remainder of packet (may be padded with zeroes!)
+              if (onPeerPathRecv(pkt, j, secret, path, path_len, extra_type, extra, extra_len)) {
+                if (pkt->isRouteFlood()) {
+                  // send a reciprocal return path to sender, but send DIRECTLY!
+                  mesh::Packet* rpath = createPathReturn(&src_hash, secret, pkt->path, pkt->path_len, 0, NULL, 0);
+                  if (rpath) sendDirect(rpath, path, path_len, 500);
                 }
-              } else {
-                onPeerDataRecv(pkt, pkt->getPayloadType(), j, secret, data, len);
               }
-              found = true;
-              break;
+            } else {
+              onPeerDataRecv(pkt, pkt->getPayloadType(), j, secret, data, len);
             }
           }
           if (found) {
@@ -177,12 +200,18 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
         if (self_id.isHashMatch(&dest_hash)) {
           Identity sender(sender_pub_key);
 
+          // decrypt, checking MAC is valid. First try an already known secret, to avoid the ECDH calc
           uint8_t secret[PUB_KEY_SIZE];
-          self_id.calcSharedSecret(secret, sender);
-
-          // decrypt, checking MAC is valid
           uint8_t data[MAX_PACKET_PAYLOAD];
-          int len = Utils::MACThenDecrypt(secret, data, macAndData, pkt->payload_len - i);
+          int len = 0;
+          if (getCachedSharedSecret(secret, sender) || getKnownSharedSecret(secret, sender)) {
+            len = getCipher(secret).MACThenDecrypt(data, macAndData, pkt->payload_len - i);
+          }
+          if (len == 0) {
+            self_id.calcSharedSecret(secret, sender);
+            len = getCipher(secret).MACThenDecrypt(data, macAndData, pkt->payload_len - i);
+            if (len > 0) putCachedSharedSecret(secret, sender);  // only once sender is shown to have the key
+          }
           if (len > 0) {  // success!
             onAnonDataRecv(pkt, secret, sender, data, len);
             pkt->markDoNotRetransmit();
@@ -201,16 +230,15 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
       if (i + 2 >= pkt->payload_len) {
         MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): incomplete data packet", getLogDateTime());
       } else if (!_tables->hasSeen(pkt)) {
-        // scan channels DB, for all matching hashes of 'channel_hash' (max 2 matches supported ATM)
-        GroupChannel channels[2];
-        int num = searchChannelsByHash(&channel_hash, channels, 2);
-        // for each matching channel, try to decrypt data
-        for (int j = 0; j < num; j++) {
-          // decrypt, checking MAC is valid
-          uint8_t data[MAX_PACKET_PAYLOAD];
-          int len = Utils::MACThenDecrypt(channels[j].secret, data, macAndData, pkt->payload_len - i);
-          if (len > 0) {  // success!
-            onGroupDataRecv(pkt, pkt->getPayloadType(), channels[j], data, len);
+        // for each channel matching 'channel_hash', check MAC, and decrypt with the first that is valid
+        // NOTE: when no channel matches (eg. repeaters), no crypto is done at all
+        for (int j = searchChannelsByHash(&channel_hash, -1); j >= 0; j = searchChannelsByHash(&channel_hash, j)) {
+          const GroupChannel* channel = getGroupChannel(j);
+          CipherContext& cipher = getChannelCipher(*channel);
+          if (cipher.verifyMAC(macAndData, pkt->payload_len - i)) {  // success!
+            uint8_t data[MAX_PACKET_PAYLOAD];
+            int len = cipher.decrypt(data, &macAndData[CIPHER_MAC_SIZE], pkt->payload_len - i - CIPHER_MAC_SIZE);
+            onGroupDataRecv(pkt, pkt->getPayloadType(), *channel, data, len);
             break;
           }
         }
@@ -225,7 +253,7 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
 
       uint32_t timestamp;
       memcpy(&timestamp, &pkt->payload[i], 4); i += 4;
-      const uint8_t* signature = &pkt->payload[i]; i += SIGNATURE_SIZE;
+      i += SIGNATURE_SIZE;   // (checked in verifyAdvert())
 
       if (i > pkt->payload_len) {
         MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): incomplete advertisement packet", getLogDateTime());
@@ -236,19 +264,17 @@ DispatcherAction Mesh::onRecvPacket(Packet* pkt) {
         int app_data_len = pkt->payload_len - i;
         if (app_data_len > MAX_ADVERT_DATA_SIZE) { app_data_len = MAX_ADVERT_DATA_SIZE; }
 
-        // check that signature is valid
-        bool is_ok;
-        {
-          uint8_t message[PUB_KEY_SIZE + 4 + MAX_ADVERT_DATA_SIZE];
-          int msg_len = 0;
-          memcpy(&message[msg_len], id.pub_key, PUB_KEY_SIZE); msg_len += PUB_KEY_SIZE;
-          memcpy(&message[msg_len], &timestamp, 4); msg_len += 4;
-          memcpy(&message[msg_len], app_data, app_data_len); msg_len += app_data_len;
-
-          is_ok = id.verify(signature, message, msg_len);
+        if (isStaleAdvert(id, timestamp)) {   // don't bother with signature check, nor forwarding
+          MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): ignoring stale/replayed advertisement", getLogDateTime());
+          break;
         }
+
+        // check that signature is valid
+        uint8_t digest[32];
+        bool is_ok = getAdvertDigest(pkt, digest) && (isVerifiedAdvert(digest) || verifyAdvert(pkt, digest));
         if (is_ok) {
           MESH_DEBUG_PRINTLN("%s Mesh::onRecvPacket(): valid advertisement received!", getLogDateTime());
+          addVerifiedAdvert(digest);
           onAdvertRecv(pkt, id, timestamp, app_data, app_data_len);
           action = routeRecvPacket(pkt);
         } else {
@@ -373,6 +399,145 @@ void Mesh::routeDirectRecvAcks(Packet* packet, uint32_t delay_millis) {
   }
 }
 
+bool Mesh::verifyAdvert(Packet* pkt, const uint8_t* digest) {
+  uint8_t message[PUB_KEY_SIZE + 4 + MAX_ADVERT_DATA_SIZE];
+  const uint8_t* signature;
+  int msg_len = getAdvertSignedMessage(pkt, message, &signature);
+  if (msg_len < 0) return false;
+
+#if MESH_ADVERT_BATCH_SIZE > 1
+  int idx = findPreVerified(digest);
+  if (idx >= 0) {   // was already verified, in an earlier batch
+    bool is_ok = _preverified[idx].state == ADVERT_VALID;
+    _preverified[idx].state = ADVERT_UNVERIFIED;   // consume it
+    return is_ok;
+  }
+
+  // other adverts waiting in the inbound (delay) queue can be verified in the same batch
+  struct {
+    uint8_t digest[32];
+    uint8_t sig[SIGNATURE_SIZE];
+    uint8_t message[PUB_KEY_SIZE + 4 + MAX_ADVERT_DATA_SIZE];
+    int msg_len;
+  } queued[MESH_ADVERT_BATCH_SIZE - 1];
+  int num = 0;
+
+  int count = _mgr->getInboundCount();
+  for (int i = 0; i < count && num < MESH_ADVERT_BATCH_SIZE - 1; i++) {
+    Packet* q = _mgr->getInboundByIdx(i);
+    if (q == NULL || q->getPayloadType() != PAYLOAD_TYPE_ADVERT || self_id.matches(q->payload)) continue;
+
+    const uint8_t* sig;
+    int len = getAdvertSignedMessage(q, queued[num].message, &sig);
+    if (len < 0) continue;
+
+    Utils::sha256(queued[num].digest, sizeof(queued[num].digest), sig, SIGNATURE_SIZE, queued[num].message, len);
+    if (memcmp(queued[num].digest, digest, sizeof(queued[num].digest)) == 0 || findPreVerified(queued[num].digest) >= 0) continue;  // dupe
+
+    uint32_t timestamp;
+    memcpy(&timestamp, &queued[num].message[PUB_KEY_SIZE], 4);
+    Identity id(queued[num].message);
+    if (isStaleAdvert(id, timestamp) || findVerifiedAdvert(queued[num].digest) >= 0) continue;  // won't need verifying
+    bool dupe = false;
+    for (int j = 0; j < num && !dupe; j++) {
+      dupe = memcmp(queued[j].digest, queued[num].digest, sizeof(queued[num].digest)) == 0;
+    }
+    if (dupe) continue;
+
+    memcpy(queued[num].sig, sig, SIGNATURE_SIZE);
+    queued[num].msg_len = len;
+    num++;
+  }
+
+  if (num > 0) {
+    const uint8_t* sigs[MESH_ADVERT_BATCH_SIZE];
+    const uint8_t* pub_keys[MESH_ADVERT_BATCH_SIZE];
+    const uint8_t* messages[MESH_ADVERT_BATCH_SIZE];
+    int msg_lens[MESH_ADVERT_BATCH_SIZE];
+    sigs[0] = signature; pub_keys[0] = message; messages[0] = message; msg_lens[0] = msg_len;
+    for (int i = 0; i < num; i++) {
+      sigs[i + 1] = queued[i].sig;
+      pub_keys[i + 1] = queued[i].message;   // message starts with the pub_key
+      messages[i + 1] = queued[i].message;
+      msg_lens[i + 1] = queued[i].msg_len;
+    }
+
+    _n_advert_batches++;
+    bool all_ok = Identity::verifyBatch(sigs, pub_keys, messages, msg_lens, num + 1, *_rng);
+    if (!all_ok) {
+      _n_advert_batch_fails++;
+      MESH_DEBUG_PRINTLN("%s Mesh::verifyAdvert(): batch of %d failed, verifying singly", getLogDateTime(), num + 1);
+    }
+    for (int i = 0; i < num; i++) {
+      bool is_ok = all_ok || Identity(queued[i].message).verify(queued[i].sig, queued[i].message, queued[i].msg_len);
+      addPreVerified(queued[i].digest, is_ok);
+    }
+    if (all_ok) return true;
+  }
+#endif
+
+  return Identity(message).verify(signature, message, msg_len);
+}
+
+bool Mesh::getCachedSharedSecret(uint8_t* dest_secret, const Identity& peer) {
+  for (int i = 0; i < MESH_SECRET_CACHE_SIZE; i++) {
+    if (_secrets[i].last_used != 0 && peer.matches(_secrets[i].pub_key)) {
+      _secrets[i].last_used = ++_secrets_counter;
+      memcpy(dest_secret, _secrets[i].secret, PUB_KEY_SIZE);
+      return true;
+    }
+  }
+  return false;
+}
+
+void Mesh::putCachedSharedSecret(const uint8_t* secret, const Identity& peer) {
+  int lru = 0;
+  for (int i = 0; i < MESH_SECRET_CACHE_SIZE; i++) {
+    if (peer.matches(_secrets[i].pub_key)) { lru = i; break; }   // replace existing
+    if (_secrets[i].last_used < _secrets[lru].last_used) lru = i;
+  }
+  memcpy(_secrets[lru].pub_key, peer.pub_key, PUB_KEY_SIZE);
+  memcpy(_secrets[lru].secret, secret, PUB_KEY_SIZE);
+  _secrets[lru].last_used = ++_secrets_counter;
+}
+
+int Mesh::findVerifiedAdvert(const uint8_t* digest) const {
+  for (int i = 0; i < MESH_VERIFIED_ADVERTS; i++) {
+    if (memcmp(_verified[i].digest, digest, sizeof(_verified[i].digest)) == 0) return i;
+  }
+  return -1;  // not found
+}
+
+bool Mesh::isVerifiedAdvert(const uint8_t* digest) {
+  if (findVerifiedAdvert(digest) < 0) return false;
+
+  _n_verify_skipped++;
+  return true;
+}
+
+void Mesh::addVerifiedAdvert(const uint8_t* digest) {
+  if (findVerifiedAdvert(digest) >= 0) return;   // already have it
+
+  memcpy(_verified[_next_verified].digest, digest, sizeof(_verified[0].digest));
+  _next_verified = (_next_verified + 1) % MESH_VERIFIED_ADVERTS;   // replace oldest
+}
+
+#if MESH_ADVERT_BATCH_SIZE > 1
+int Mesh::findPreVerified(const uint8_t* digest) const {
+  for (int i = 0; i < MESH_ADVERT_BATCH_SIZE; i++) {
+    const PreVerifiedAdvert& p = _preverified[i];
+    if (p.state != ADVERT_UNVERIFIED && memcmp(p.digest, digest, sizeof(p.digest)) == 0) return i;
+  }
+  return -1;  // not found
+}
+
+void Mesh::addPreVerified(const uint8_t* digest, bool is_ok) {
+  memcpy(_preverified[_next_preverified].digest, digest, sizeof(_preverified[0].digest));
+  _preverified[_next_preverified].state = is_ok ? ADVERT_VALID : ADVERT_FORGED;
+  _next_preverified = (_next_preverified + 1) % MESH_ADVERT_BATCH_SIZE;   // oldest (probably dropped as dupe) gets replaced
+}
+#endif
+
 Packet* Mesh::createAdvert(const LocalIdentity& id, const uint8_t* app_data, size_t app_data_len) {
   if (app_data_len > MAX_ADVERT_DATA_SIZE) return NULL;
 
@@ -446,7 +611,7 @@ Packet* Mesh::createPathReturn(const uint8_t* dest_hash, const uint8_t* secret,
       getRNG()->random(&data[data_len], 4); data_len += 4;
     }
 
-    len += Utils::encryptThenMAC(secret, &packet->payload[len], data, data_len);
+    len += getCipher(secret).encryptThenMAC(&packet->payload[len], data, data_len);
   }
 
   packet->payload_len = len;
@@ -471,7 +636,7 @@ Packet* Mesh::createDatagram(uint8_t type, const Identity& dest, const uint8_t*
   int len = 0;
   len += dest.copyHashTo(&packet->payload[len]);  // dest hash
   len += self_id.copyHashTo(&packet->payload[len]);  // src hash
-  len += Utils::encryptThenMAC(secret, &packet->payload[len], data, data_len);
+  len += getCipher(secret).encryptThenMAC(&packet->payload[len], data, data_len);
 
   packet->payload_len = len;
 
@@ -499,7 +664,7 @@ Packet* Mesh::createAnonDatagram(uint8_t type, const LocalIdentity& sender, cons
   } else {
     // FUTURE:
   }
-  len += Utils::encryptThenMAC(secret, &packet->payload[len], data, data_len);
+  len += getCipher(secret).encryptThenMAC(&packet->payload[len], data, data_len);
 
   packet->payload_len = len;
 
@@ -519,7 +684,7 @@ Packet* Mesh::createGroupDatagram(uint8_t type, const GroupChannel& channel, con
 
   int len = 0;
   memcpy(&packet->payload[len], channel.hash, PATH_HASH_SIZE); len += PATH_HASH_SIZE;
-  len += Utils::encryptThenMAC(channel.secret, &packet->payload[len], data, data_len);
+  len += getChannelCipher(channel).encryptThenMAC(&packet->payload[len], data, data_len);
 
   packet->payload_len = len;
 
@@ -597,6 +762,7 @@ void Mesh::sendFlood(Packet* packet, uint32_t delay_millis) {
   packet->header |= ROUTE_TYPE_FLOOD;
   packet->path_len = 0;
 
+  packet->invalidateHash();   // payload may have been (re)built in-place
   _tables->hasSeen(packet); // mark this packet as already sent in case it is rebroadcast back to us
 
   uint8_t pri;
@@ -630,6 +796,7 @@ void Mesh::sendDirect(Packet* packet, const uint8_t* path, uint8_t path_len, uin
       pri = 0;
     }
   }
+  packet->invalidateHash();   // payload may have been (re)built in-place
   _tables->hasSeen(packet); // mark this packet as already sent in case it is rebroadcast back to us
   sendPacket(packet, pri, delay_millis);
 }
@@ -640,6 +807,7 @@ void Mesh::sendZeroHop(Packet* packet, uint32_t delay_millis) {
 
   packet->path_len = 0;  // path_len of zero means Zero Hop
 
+  packet->invalidateHash();   // payload may have been (re)built in-place
   _tables->hasSeen(packet); // mark this packet as already sent in case it is rebroadcast back to us
 
   sendPacket(packet, 0, delay_millis);
@@ -2,6 +2,34 @@
 
 #include <Dispatcher.h>
 
+#ifndef MESH_CIPHER_CACHE_SIZE
+  #define MESH_CIPHER_CACHE_SIZE   8    // number of recently used peer secrets to keep keyed crypto state for
+#endif
+
+#ifndef MESH_CHANNEL_CIPHER_CACHE_SIZE
+  #define MESH_CHANNEL_CIPHER_CACHE_SIZE   4    // same, for group channels (kept apart, so peer traffic can't evict them)
+#endif
+
+#ifndef MESH_ADVERT_BATCH_SIZE
+  #define MESH_ADVERT_BATCH_SIZE   8    // max adverts to signature check together, when waiting in inbound queue (1 = off)
+#endif
+
+#ifndef MESH_SECRET_CACHE_SIZE
+  #define MESH_SECRET_CACHE_SIZE   4    // number of recent ANON_REQ senders to keep ECDH shared-secrets for
+#endif
+
+#ifndef MESH_VERIFIED_ADVERTS
+  #define MESH_VERIFIED_ADVERTS   32    // number of recently verified adverts to remember (to skip re-verifying)
+#endif
+
+#if MESH_ADVERT_BATCH_SIZE > MAX_VERIFY_BATCH
+  #error "MESH_ADVERT_BATCH_SIZE is too large"
+#endif
+
+#define ADVERT_UNVERIFIED   0
+#define ADVERT_VALID        1
+#define ADVERT_FORGED       2
+
 namespace mesh {
 
 class GroupChannel {
@@ -27,6 +55,43 @@ class Mesh : public Dispatcher {
   RTCClock* _rtc;
   RNG* _rng;
   MeshTables* _tables;
+  CipherContextCache _ciphers, _channel_ciphers;
+#if MESH_ADVERT_BATCH_SIZE > 1
+  struct PreVerifiedAdvert {
+    uint8_t digest[32];   // full SHA-256 of signature + signed message (NOT the truncated packet hash)
+    uint8_t state;
+  };
+  PreVerifiedAdvert _preverified[MESH_ADVERT_BATCH_SIZE];   // results for adverts still in inbound queue
+  int _next_preverified;
+  uint32_t _n_advert_batches, _n_advert_batch_fails;
+
+  int findPreVerified(const uint8_t* digest) const;
+  void addPreVerified(const uint8_t* digest, bool is_ok);
+#endif
+
+  struct CachedSecret {
+    uint8_t pub_key[PUB_KEY_SIZE];
+    uint8_t secret[PUB_KEY_SIZE];
+    uint32_t last_used;   // 0 = empty slot
+  };
+  CachedSecret _secrets[MESH_SECRET_CACHE_SIZE];
+  uint32_t _secrets_counter;
+
+  bool getCachedSharedSecret(uint8_t* dest_secret, const Identity& peer);
+  void putCachedSharedSecret(const uint8_t* secret, const Identity& peer);
+
+  struct VerifiedAdvert {
+    uint8_t digest[32];   // full SHA-256 of signature + signed message (pub_key, timestamp, app_data)
+  };
+  VerifiedAdvert _verified[MESH_VERIFIED_ADVERTS];
+  int _next_verified;
+  uint32_t _n_verify_skipped;
+  uint32_t _n_peer_collisions, _n_peer_mac_fails;
+
+  int findVerifiedAdvert(const uint8_t* digest) const;
+  bool isVerifiedAdvert(const uint8_t* digest);
+  void addVerifiedAdvert(const uint8_t* digest);
+  bool verifyAdvert(Packet* pkt, const uint8_t* digest);
 
   void removeSelfFromPath(Packet* packet);
   void routeDirectRecvAcks(Packet* packet, uint32_t delay_millis);
@@ -77,6 +142,13 @@ protected:
    */
   virtual void getPeerSharedSecret(uint8_t* dest_secret, int peer_idx) { }
 
+  /**
+   * \brief  lookup an already calculated ECDH shared-secret for given peer, eg. from a contacts/ACL table.
+   *         (used for ANON_REQ, before resorting to calcSharedSecret())
+   * \returns  false, if peer is not known
+   */
+  virtual bool getKnownSharedSecret(uint8_t* dest_secret, const Identity& peer) { return false; }
+
   /**
    * \brief  A (now decrypted) data packet has been received (by a known peer).
    *         NOTE: these can be received multiple times (per sender/msg-id), via different routes
@@ -108,6 +180,13 @@ protected:
   */
   virtual bool onPeerPathRecv(Packet* packet, int sender_idx, const uint8_t* secret, uint8_t* path, uint8_t path_len, uint8_t extra_type, uint8_t* extra, uint8_t extra_len) { return false; }
 
+  /**
+   * \brief  Pre-check of an incoming Advertisement, before the (expensive) signature check.
+   * \returns  true, if 'timestamp' is not newer than the last advert from this peer (ie. is a replay), so can be
+   *           ignored (and not forwarded)
+  */
+  virtual bool isStaleAdvert(const Identity& id, uint32_t timestamp) { return false; }
+
   /**
    * \brief  A new incoming Advertisement has been received.
    *         NOTE: these can be received multiple times (per id/timestamp), via different routes
@@ -134,11 +213,16 @@ protected:
   virtual void onRawDataRecv(Packet* packet) { }
 
   /**
-   * \brief  Perform search of local DB of matching GroupChannels.
-   * \param  channels  OUT - store matching channels in this array, up to max_matches
-   * \returns  Number of channels with matching hash
+   * \brief  Iterate the local DB of GroupChannels, for those with matching hash.
+   * \param  prev_idx  index returned by the previous call, or -1 to get the first match
+   * \returns  index of next matching channel (for getGroupChannel()), or -1 if no more
+   */
+  virtual int searchChannelsByHash(const uint8_t* hash, int prev_idx) { return -1; }
+
+  /**
+   * \returns  the GroupChannel at given index, as returned by searchChannelsByHash()
    */
-  virtual int searchChannelsByHash(const uint8_t* hash, GroupChannel channels[], int max_matches);
+  virtual const GroupChannel* getGroupChannel(int idx) { return NULL; }
 
   /**
    * \brief  An encrypted group data packet has been received.
@@ -155,12 +239,32 @@ protected:
   virtual void onAckRecv(Packet* packet, uint32_t ack_crc) { }
 
   Mesh(Radio& radio, MillisecondClock& ms, RNG& rng, RTCClock& rtc, PacketManager& mgr, MeshTables& tables)
-    : Dispatcher(radio, ms, mgr), _rng(&rng), _rtc(&rtc), _tables(&tables)
+    : Dispatcher(radio, ms, mgr), _rng(&rng), _rtc(&rtc), _tables(&tables), _ciphers(MESH_CIPHER_CACHE_SIZE),
+      _channel_ciphers(MESH_CHANNEL_CIPHER_CACHE_SIZE)
   {
+    memset(_secrets, 0, sizeof(_secrets));
+    _secrets_counter = 0;
+    memset(_verified, 0, sizeof(_verified));
+    _next_verified = 0;
+    _n_verify_skipped = 0;
+    _n_peer_collisions = _n_peer_mac_fails = 0;
+#if MESH_ADVERT_BATCH_SIZE > 1
+    memset(_preverified, 0, sizeof(_preverified));
+    _next_preverified = 0;
+    _n_advert_batches = _n_advert_batch_fails = 0;
+#endif
   }
 
   MeshTables* getTables() const { return _tables; }
 
+  /**
+   * \returns  the cached keyed crypto state for given shared-secret
+   */
+  CipherContext& getCipher(const uint8_t* secret) { return _ciphers.get(secret); }
+  CipherContext& getChannelCipher(const GroupChannel& channel) { return _channel_ciphers.get(channel.secret); }
+  const CipherContextCache& getCipherCache() const { return _ciphers; }
+  const CipherContextCache& getChannelCipherCache() const { return _channel_ciphers; }
+
 public:
   void begin();
   void loop();
@@ -170,6 +274,14 @@ public:
   RNG* getRNG() const { return _rng; }
   RTCClock* getRTCClock() const { return _rtc; }
 
+  uint32_t getNumVerifySkipped() const { return _n_verify_skipped; }
+  uint32_t getNumPeerCollisions() const { return _n_peer_collisions; }   // packets for us, with multiple peers matching src_hash
+  uint32_t getNumPeerMACFails() const { return _n_peer_mac_fails; }      // candidate peers rejected by MAC check
+#if MESH_ADVERT_BATCH_SIZE > 1
+  uint32_t getNumAdvertBatches() const { return _n_advert_batches; }
+  uint32_t getNumAdvertBatchFails() const { return _n_advert_batch_fails; }
+#endif
+
   Packet* createAdvert(const LocalIdentity& id, const uint8_t* app_data=NULL, size_t app_data_len=0);
   Packet* createDatagram(uint8_t type, const Identity& dest, const uint8_t* secret, const uint8_t* data, size_t len);
   Packet* createAnonDatagram(uint8_t type, const LocalIdentity& sender, const Identity& dest, const uint8_t* secret, const uint8_t* data, size_t data_len);
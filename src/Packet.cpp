@@ -1,6 +1,7 @@
 #include "Packet.h"
 #include <string.h>
-#include <SHA256.h>
+#include "CryptoBackend.h"
+#include "SHA256Batch.h"
 
 namespace mesh {
 
@@ -8,6 +9,7 @@ Packet::Packet() {
   header = 0;
   path_len = 0;
   payload_len = 0;
+  invalidateHash();
 }
 
 int Packet::getRawLength() const {
@@ -15,14 +17,56 @@ int Packet::getRawLength() const {
 }
 
 void Packet::calculatePacketHash(uint8_t* hash) const {
-  SHA256 sha;
   uint8_t t = getPayloadType();
-  sha.update(&t, 1);
-  if (t == PAYLOAD_TYPE_TRACE) {
-    sha.update(&path_len, sizeof(path_len));   // CAVEAT: TRACE packets can revisit same node on return path
+  uint8_t trace_path_len = t == PAYLOAD_TYPE_TRACE ? path_len : 0;
+  if (_hash_type != t || _hash_payload_len != payload_len || _hash_path_len != trace_path_len) {
+    CryptoSHA256 sha;
+    sha.update(&t, 1);
+    if (t == PAYLOAD_TYPE_TRACE) {
+      sha.update(&path_len, sizeof(path_len));   // CAVEAT: TRACE packets can revisit same node on return path
+    }
+    sha.update(payload, payload_len);
+    sha.finalize(_hash, MAX_HASH_SIZE);
+
+    _hash_type = t;
+    _hash_payload_len = payload_len;
+    _hash_path_len = trace_path_len;
+  }
+  memcpy(hash, _hash, MAX_HASH_SIZE);
+}
+
+#define HASH_BATCH_SIZE   8
+
+void Packet::hashPackets(const Packet* const packets[], int count, uint8_t* dest_hashes) {
+  uint8_t msgs[HASH_BATCH_SIZE][1 + sizeof(path_len) + MAX_PACKET_PAYLOAD];   // same input as calculatePacketHash()
+  const uint8_t* msg_ptrs[HASH_BATCH_SIZE];
+  int msg_lens[HASH_BATCH_SIZE];
+
+  for (int i = 0; i < count; i += HASH_BATCH_SIZE) {
+    int n = count - i < HASH_BATCH_SIZE ? count - i : HASH_BATCH_SIZE;
+    for (int j = 0; j < n; j++) {
+      const Packet* pkt = packets[i + j];
+      uint8_t t = pkt->getPayloadType();
+      int len = 0;
+      msgs[j][len++] = t;
+      if (t == PAYLOAD_TYPE_TRACE) {
+        memcpy(&msgs[j][len], &pkt->path_len, sizeof(pkt->path_len)); len += sizeof(pkt->path_len);
+      }
+      memcpy(&msgs[j][len], pkt->payload, pkt->payload_len); len += pkt->payload_len;
+      msg_ptrs[j] = msgs[j];
+      msg_lens[j] = len;
+    }
+    SHA256Batch::hash(&dest_hashes[i * MAX_HASH_SIZE], MAX_HASH_SIZE, msg_ptrs, msg_lens, n);
+
+    for (int j = 0; j < n; j++) {   // update each packet's cache
+      const Packet* pkt = packets[i + j];
+      uint8_t t = pkt->getPayloadType();
+      memcpy(pkt->_hash, &dest_hashes[(i + j) * MAX_HASH_SIZE], MAX_HASH_SIZE);
+      pkt->_hash_type = t;
+      pkt->_hash_payload_len = pkt->payload_len;
+      pkt->_hash_path_len = t == PAYLOAD_TYPE_TRACE ? pkt->path_len : 0;
+    }
   }
-  sha.update(payload, payload_len);
-  sha.finalize(hash, MAX_HASH_SIZE);
 }
 
 uint8_t Packet::writeTo(uint8_t dest[]) const {
@@ -39,6 +83,7 @@ uint8_t Packet::writeTo(uint8_t dest[]) const {
 }
 
 bool Packet::readFrom(const uint8_t src[], uint8_t len) {
+  invalidateHash();
   uint8_t i = 0;
   header = src[i++];
   if (hasTransportCodes()) {
@@ -39,6 +39,10 @@ namespace mesh {
  * \brief  The fundamental transmission unit.
 */
 class Packet {
+  mutable uint8_t _hash[MAX_HASH_SIZE];   // cache for calculatePacketHash()
+  mutable uint8_t _hash_type;             // payload type the cached hash is for, or 0xFF if none
+  mutable uint8_t _hash_payload_len, _hash_path_len;
+
 public:
   Packet();
 
@@ -48,13 +52,31 @@ public:
   uint8_t path[MAX_PATH_SIZE];
   uint8_t payload[MAX_PACKET_PAYLOAD];
   int8_t _snr;
+#if MESH_LATENCY_STATS
+  uint32_t _t_origin;   // millis when received from radio, or first sent
+  uint32_t _t_queued;   // millis when last put in an inbound/outbound queue
+#endif
 
   /**
-   * \brief calculate the hash of payload + type
+   * \brief calculate the hash of payload + type.  The result is cached, until the type, payload_len, or (for TRACE)
+   *        path_len change, or invalidateHash() is called.
    * \param  dest_hash   destination to store the hash (must be MAX_HASH_SIZE bytes)
    */
   void calculatePacketHash(uint8_t* dest_hash) const;
 
+  /**
+   * \brief  calculatePacketHash() of many packets at once, using SHA256Batch (ie. SIMD lanes, on x86-64 hosts).
+   *         For host-side tools handling large numbers of packets. Each packet's cached hash is updated too.
+   * \param  dest_hashes  destination, must be count * MAX_HASH_SIZE bytes
+   */
+  static void hashPackets(const Packet* const packets[], int count, uint8_t* dest_hashes);
+
+  /**
+   * \brief  must be called after modifying payload[] in-place (ie. without changing payload_len), if the hash may
+   *         have already been calculated.
+   */
+  void invalidateHash() { _hash_type = 0xFF; }
+
   /**
    * \returns  one of ROUTE_ values
    */
@@ -0,0 +1,167 @@
+#include "SHA256Batch.h"
+#include "Utils.h"
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+  #define SHA256_BATCH_SIMD   1
+#endif
+
+namespace mesh {
+
+static void hashOne(uint8_t* hash, size_t hash_len, const uint8_t* msg, int msg_len) {
+  CryptoSHA256 sha;
+  sha.update(msg, msg_len);
+  sha.finalize(hash, hash_len);
+}
+
+#if SHA256_BATCH_SIMD
+
+static const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+static const uint32_t H0[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+typedef uint32_t vec4 __attribute__((vector_size(16)));
+typedef uint32_t vec8 __attribute__((vector_size(32)));
+
+#define INLINE   static inline __attribute__((always_inline))
+
+#define ROTR(x, n)   (((x) >> (n)) | ((x) << (32 - (n))))   // (a macro, as vectors may not be passed/returned by value)
+
+INLINE uint32_t loadBE32(const uint8_t* p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/*
+ * One message per lane, each word of the state/schedule being a vector of that word for all N lanes. Messages
+ * of different lengths: a lane's state stops changing once its own blocks are done.
+ */
+template <typename V, int N>
+INLINE void hashLanes(uint8_t* hashes, size_t hash_len, const uint8_t* const msgs[], const int msg_lens[], int n) {
+  static const uint8_t zeroes[64] = { 0 };
+  uint8_t tail[N][128];    // final (partial) block(s), with padding and length
+  int num_full[N], num_blocks[N];
+  int max_blocks = 0;
+
+  for (int l = 0; l < N; l++) {
+    int len = l < n ? msg_lens[l] : 0;
+    int rem = len % 64;
+    num_full[l] = len / 64;
+    int tail_len = rem + 9 <= 64 ? 64 : 128;
+    num_blocks[l] = l < n ? num_full[l] + tail_len / 64 : 0;
+    if (num_blocks[l] > max_blocks) max_blocks = num_blocks[l];
+
+    memset(tail[l], 0, tail_len);
+    if (l < n) memcpy(tail[l], &msgs[l][num_full[l] * 64], rem);
+    tail[l][rem] = 0x80;
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; i++) tail[l][tail_len - 1 - i] = bits >> (i * 8);
+  }
+
+  V h[8];
+  for (int i = 0; i < 8; i++) {
+    for (int l = 0; l < N; l++) h[i][l] = H0[i];
+  }
+
+  for (int b = 0; b < max_blocks; b++) {
+    V w[16], active;
+    for (int l = 0; l < N; l++) {
+      const uint8_t* p;
+      if (b < num_full[l]) {
+        p = &msgs[l][b * 64];
+      } else if (b < num_blocks[l]) {
+        p = &tail[l][(b - num_full[l]) * 64];
+      } else {
+        p = zeroes;   // lane already finished
+      }
+      for (int i = 0; i < 16; i++) w[i][l] = loadBE32(&p[i * 4]);
+      active[l] = b < num_blocks[l] ? 0xFFFFFFFF : 0;
+    }
+
+    V a = h[0], bb = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+    for (int i = 0; i < 64; i++) {
+      V wi;
+      if (i < 16) {
+        wi = w[i];
+      } else {
+        V w15 = w[(i + 1) & 15], w2 = w[(i + 14) & 15];
+        wi = w[i & 15] + (ROTR(w15, 7) ^ ROTR(w15, 18) ^ (w15 >> 3)) + w[(i + 9) & 15]
+           + (ROTR(w2, 17) ^ ROTR(w2, 19) ^ (w2 >> 10));
+        w[i & 15] = wi;
+      }
+      V t1 = hh + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + (g ^ (e & (f ^ g))) + K[i] + wi;
+      V t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & bb) | (c & (a | bb)));
+      hh = g; g = f; f = e; e = d + t1; d = c; c = bb; bb = a; a = t1 + t2;
+    }
+    h[0] += a & active; h[1] += bb & active; h[2] += c & active; h[3] += d & active;
+    h[4] += e & active; h[5] += f & active; h[6] += g & active; h[7] += hh & active;
+  }
+
+  for (int l = 0; l < n; l++) {
+    uint8_t digest[32];
+    for (int i = 0; i < 8; i++) {
+      uint32_t v = h[i][l];
+      digest[i*4] = v >> 24; digest[i*4 + 1] = v >> 16; digest[i*4 + 2] = v >> 8; digest[i*4 + 3] = v;
+    }
+    memcpy(&hashes[l * hash_len], digest, hash_len);
+  }
+}
+
+static void hash4(uint8_t* hashes, size_t hash_len, const uint8_t* const msgs[], const int msg_lens[], int n) {
+  hashLanes<vec4, 4>(hashes, hash_len, msgs, msg_lens, n);   // SSE2 is baseline on x86-64
+}
+
+__attribute__((target("avx2")))
+static void hash8(uint8_t* hashes, size_t hash_len, const uint8_t* const msgs[], const int msg_lens[], int n) {
+  hashLanes<vec8, 8>(hashes, hash_len, msgs, msg_lens, n);
+}
+
+static bool hasAVX2() {
+  static int avx2 = -1;
+  if (avx2 < 0) avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+  return avx2 == 1;
+}
+
+#endif
+
+void SHA256Batch::hash(uint8_t* hashes, size_t hash_len, const uint8_t* const msgs[], const int msg_lens[], int count) {
+  if (hash_len > 32) hash_len = 32;
+
+  int i = 0;
+#if SHA256_BATCH_SIMD
+  bool avx2 = hasAVX2();
+  while (count - i >= 2) {
+    int n = count - i;
+    if (avx2) {
+      if (n > 8) n = 8;
+      hash8(&hashes[i * hash_len], hash_len, &msgs[i], &msg_lens[i], n);
+    } else {
+      if (n > 4) n = 4;
+      hash4(&hashes[i * hash_len], hash_len, &msgs[i], &msg_lens[i], n);
+    }
+    i += n;
+  }
+#endif
+  for ( ; i < count; i++) {
+    hashOne(&hashes[i * hash_len], hash_len, msgs[i], msg_lens[i]);
+  }
+}
+
+const char* SHA256Batch::getImplName() {
+#if SHA256_BATCH_SIMD
+  return hasAVX2() ? "avx2x8" : "sse2x4";
+#else
+  return "scalar";
+#endif
+}
+
+}
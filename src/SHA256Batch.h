@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mesh {
+
+/**
+ * \brief  SHA-256 of many independent messages at once, for host-side tools (simulator, bridges, log analysers)
+ *         which hash large numbers of packets. On x86-64 hosts the messages are hashed side by side in SIMD lanes
+ *         (8 with AVX2, otherwise 4 with SSE2), elsewhere one at a time with CryptoSHA256. Same results either way.
+ */
+class SHA256Batch {
+public:
+  /**
+   * \param  hashes  OUT - count * hash_len bytes, ie. each hash truncated to 'hash_len' (max 32)
+   */
+  static void hash(uint8_t* hashes, size_t hash_len, const uint8_t* const msgs[], const int msg_lens[], int count);
+
+  /**
+   * \returns  which implementation hash() uses on this machine, eg. "avx2x8"
+   */
+  static const char* getImplName();
+};
+
+}
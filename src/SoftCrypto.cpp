@@ -0,0 +1,339 @@
+#include "SoftCrypto.h"
+#include <string.h>
+
+namespace mesh {
+
+/* ---------------------------------- AES-128 ---------------------------------- */
+
+// State layout: q[b] bit (j + 16*n) = bit b of byte j (= column*4 + row) of block n.
+
+static void sbox(uint32_t* q) {   // Boyar-Peralta S-box circuit
+  uint32_t x0, x1, x2, x3, x4, x5, x6, x7;
+  uint32_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+  uint32_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9, z10, z11, z12, z13, z14, z15, z16, z17;
+  uint32_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+  uint32_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+  uint32_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+  uint32_t t60, t61, t62, t63, t64, t65, t66, t67;
+  uint32_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+  x0 = q[7]; x1 = q[6]; x2 = q[5]; x3 = q[4]; x4 = q[3]; x5 = q[2]; x6 = q[1]; x7 = q[0];
+
+  // top linear transform
+  y14 = x3 ^ x5;   y13 = x0 ^ x6;   y9 = x0 ^ x3;    y8 = x0 ^ x5;
+  t0 = x1 ^ x2;    y1 = t0 ^ x7;    y4 = y1 ^ x3;    y12 = y13 ^ y14;
+  y2 = y1 ^ x0;    y5 = y1 ^ x6;    y3 = y5 ^ y8;    t1 = x4 ^ y12;
+  y15 = t1 ^ x5;   y20 = t1 ^ x1;   y6 = y15 ^ x7;   y10 = y15 ^ t0;
+  y11 = y20 ^ y9;  y7 = x7 ^ y11;   y17 = y10 ^ y11; y19 = y10 ^ y8;
+  y16 = t0 ^ y11;  y21 = y13 ^ y16; y18 = x0 ^ y16;
+
+  // non-linear section (GF(2^8) inversion)
+  t2 = y12 & y15;  t3 = y3 & y6;    t4 = t3 ^ t2;    t5 = y4 & x7;
+  t6 = t5 ^ t2;    t7 = y13 & y16;  t8 = y5 & y1;    t9 = t8 ^ t7;
+  t10 = y2 & y7;   t11 = t10 ^ t7;  t12 = y9 & y11;  t13 = y14 & y17;
+  t14 = t13 ^ t12; t15 = y8 & y10;  t16 = t15 ^ t12; t17 = t4 ^ t14;
+  t18 = t6 ^ t16;  t19 = t9 ^ t14;  t20 = t11 ^ t16; t21 = t17 ^ y20;
+  t22 = t18 ^ y19; t23 = t19 ^ y21; t24 = t20 ^ y18;
+
+  t25 = t21 ^ t22; t26 = t21 & t23; t27 = t24 ^ t26; t28 = t25 & t27;
+  t29 = t28 ^ t22; t30 = t23 ^ t24; t31 = t22 ^ t26; t32 = t31 & t30;
+  t33 = t32 ^ t24; t34 = t23 ^ t33; t35 = t27 ^ t33; t36 = t24 & t35;
+  t37 = t36 ^ t34; t38 = t27 ^ t36; t39 = t29 & t38; t40 = t25 ^ t39;
+
+  t41 = t40 ^ t37; t42 = t29 ^ t33; t43 = t29 ^ t40; t44 = t33 ^ t37;
+  t45 = t42 ^ t41;
+  z0 = t44 & y15;  z1 = t37 & y6;   z2 = t33 & x7;   z3 = t43 & y16;
+  z4 = t40 & y1;   z5 = t29 & y7;   z6 = t42 & y11;  z7 = t45 & y17;
+  z8 = t41 & y10;  z9 = t44 & y12;  z10 = t37 & y3;  z11 = t33 & y4;
+  z12 = t43 & y13; z13 = t40 & y5;  z14 = t29 & y2;  z15 = t42 & y9;
+  z16 = t45 & y14; z17 = t41 & y8;
+
+  // bottom linear transform
+  t46 = z15 ^ z16; t47 = z10 ^ z11; t48 = z5 ^ z13;  t49 = z9 ^ z10;
+  t50 = z2 ^ z12;  t51 = z2 ^ z5;   t52 = z7 ^ z8;   t53 = z0 ^ z3;
+  t54 = z6 ^ z7;   t55 = z16 ^ z17; t56 = z12 ^ t48; t57 = t50 ^ t53;
+  t58 = z4 ^ t46;  t59 = z3 ^ t54;  t60 = t46 ^ t57; t61 = z14 ^ t57;
+  t62 = t52 ^ t58; t63 = t49 ^ t58; t64 = z4 ^ t59;  t65 = t61 ^ t62;
+  t66 = z1 ^ t63;  s0 = t59 ^ t63;  s6 = t56 ^ ~t62; s7 = t48 ^ ~t60;
+  t67 = t64 ^ t65; s3 = t53 ^ t66;  s4 = t51 ^ t66;  s5 = t47 ^ t65;
+  s1 = t64 ^ ~s3;  s2 = t55 ^ ~t67;
+
+  q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3; q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+}
+
+static void invAffine(uint32_t* q) {   // inverse of the S-box's affine transform
+  uint32_t t[8];
+  for (int i = 0; i < 8; i++) t[i] = q[(i + 2) & 7] ^ q[(i + 5) & 7] ^ q[(i + 7) & 7];
+  t[0] = ~t[0]; t[2] = ~t[2];   // ^ 0x05
+  memcpy(q, t, sizeof(t));
+}
+
+static void invSbox(uint32_t* q) {
+  invAffine(q);
+  sbox(q);
+  invAffine(q);
+}
+
+static inline uint32_t rotrHalves(uint32_t x, int k) {   // rotate right each 16-bit half (ie. each block) by k
+  uint32_t lo = (0xFFFFu >> k) * 0x10001u;
+  return ((x >> k) & lo) | ((x << (16 - k)) & ~lo);
+}
+
+static void shiftRows(uint32_t* q) {   // row r: rotate left by r columns
+  for (int b = 0; b < 8; b++) {
+    uint32_t x = q[b];
+    q[b] = (x & 0x11111111) | rotrHalves(x & 0x22222222, 4) | rotrHalves(x & 0x44444444, 8) | rotrHalves(x & 0x88888888, 12);
+  }
+}
+
+static void invShiftRows(uint32_t* q) {
+  for (int b = 0; b < 8; b++) {
+    uint32_t x = q[b];
+    q[b] = (x & 0x11111111) | rotrHalves(x & 0x22222222, 12) | rotrHalves(x & 0x44444444, 8) | rotrHalves(x & 0x88888888, 4);
+  }
+}
+
+// the byte in row r+1, r+2, r+3 (mod 4) of same column
+static inline uint32_t rowUp1(uint32_t x) { return ((x >> 1) & 0x77777777) | ((x << 3) & 0x88888888); }
+static inline uint32_t rowUp2(uint32_t x) { return ((x >> 2) & 0x33333333) | ((x << 2) & 0xCCCCCCCC); }
+static inline uint32_t rowUp3(uint32_t x) { return ((x << 1) & 0xEEEEEEEE) | ((x >> 3) & 0x11111111); }
+
+static void xtime(uint32_t* d, const uint32_t* a) {   // d = a * 2, in GF(2^8)
+  uint32_t hi = a[7];
+  d[7] = a[6]; d[6] = a[5]; d[5] = a[4]; d[4] = a[3] ^ hi;
+  d[3] = a[2] ^ hi; d[2] = a[1]; d[1] = a[0] ^ hi; d[0] = hi;
+}
+
+static void mixColumns(uint32_t* q) {   // 2*a[r] ^ 3*a[r+1] ^ a[r+2] ^ a[r+3]
+  uint32_t t[8], t2[8];
+  for (int b = 0; b < 8; b++) t[b] = q[b] ^ rowUp1(q[b]);
+  xtime(t2, t);
+  for (int b = 0; b < 8; b++) q[b] = t2[b] ^ rowUp1(q[b]) ^ rowUp2(q[b]) ^ rowUp3(q[b]);
+}
+
+static void invMixColumns(uint32_t* q) {   // = mixColumns() after a[r] ^= 4*(a[r] ^ a[r+2])
+  uint32_t w[8], u[8];
+  for (int b = 0; b < 8; b++) w[b] = q[b] ^ rowUp2(q[b]);
+  xtime(u, w);
+  xtime(w, u);
+  for (int b = 0; b < 8; b++) q[b] ^= w[b];
+  mixColumns(q);
+}
+
+static inline void addRoundKey(uint32_t* q, const uint16_t* rk) {
+  for (int b = 0; b < 8; b++) q[b] ^= rk[b] * 0x10001u;
+}
+
+static inline uint64_t transpose8x8(uint64_t x) {   // bit j of byte i <-> bit i of byte j
+  uint64_t t;
+  t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;  x ^= t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL; x ^= t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL; x ^= t ^ (t << 28);
+  return x;
+}
+
+static void load(uint32_t* q, const uint8_t* in, int num_blocks) {   // num_blocks: 1 or 2
+  memset(q, 0, 8*sizeof(uint32_t));
+  for (int h = 0; h < 2*num_blocks; h++) {   // each 8 bytes
+    uint64_t x = 0;
+    for (int i = 7; i >= 0; i--) x = (x << 8) | in[h*8 + i];
+    x = transpose8x8(x);
+    for (int b = 0; b < 8; b++) q[b] |= (uint32_t)((x >> (b*8)) & 0xFF) << (h*8);
+  }
+}
+
+static void store(uint8_t* out, const uint32_t* q, int num_blocks) {
+  for (int h = 0; h < 2*num_blocks; h++) {
+    uint64_t x = 0;
+    for (int b = 7; b >= 0; b--) x = (x << 8) | ((q[b] >> (h*8)) & 0xFF);
+    x = transpose8x8(x);
+    for (int i = 0; i < 8; i++) out[h*8 + i] = x >> (i*8);
+  }
+}
+
+bool SoftAES128::setKey(const uint8_t* key, size_t len) {
+  if (len != 16) return false;
+
+  uint8_t w[176];
+  memcpy(w, key, 16);
+  uint8_t rcon = 1;
+  for (int i = 16; i < 176; i += 4) {
+    uint8_t t[4];
+    memcpy(t, &w[i - 4], 4);
+    if ((i & 15) == 0) {   // RotWord, SubWord (bitsliced, so also constant-time), Rcon
+      uint32_t q[8];
+      uint8_t rot[4] = { t[1], t[2], t[3], t[0] };
+      memset(q, 0, sizeof(q));
+      for (int j = 0; j < 4; j++) {
+        for (int b = 0; b < 8; b++) q[b] |= (uint32_t)((rot[j] >> b) & 1) << j;
+      }
+      sbox(q);
+      for (int j = 0; j < 4; j++) {
+        uint8_t v = 0;
+        for (int b = 0; b < 8; b++) v |= ((q[b] >> j) & 1) << b;
+        t[j] = v;
+      }
+      t[0] ^= rcon;
+      rcon = (rcon << 1) ^ ((rcon >> 7) * 0x1B);
+    }
+    for (int j = 0; j < 4; j++) w[i + j] = w[i - 16 + j] ^ t[j];
+  }
+
+  for (int r = 0; r < 11; r++) {
+    uint32_t q[8];
+    load(q, &w[r*16], 1);
+    for (int b = 0; b < 8; b++) _rk[r][b] = q[b];
+  }
+  memset(w, 0, sizeof(w));
+  return true;
+}
+
+void SoftAES128::encryptBlocks(uint8_t* out, const uint8_t* in, int num_blocks) {
+  uint32_t q[8];
+  while (num_blocks > 0) {
+    int n = num_blocks >= 2 ? 2 : 1;
+    load(q, in, n);
+    addRoundKey(q, _rk[0]);
+    for (int r = 1; r < 10; r++) {
+      sbox(q);
+      shiftRows(q);
+      mixColumns(q);
+      addRoundKey(q, _rk[r]);
+    }
+    sbox(q);
+    shiftRows(q);
+    addRoundKey(q, _rk[10]);
+    store(out, q, n);
+
+    in += 16*n; out += 16*n; num_blocks -= n;
+  }
+}
+
+void SoftAES128::decryptBlocks(uint8_t* out, const uint8_t* in, int num_blocks) {
+  uint32_t q[8];
+  while (num_blocks > 0) {
+    int n = num_blocks >= 2 ? 2 : 1;
+    load(q, in, n);
+    addRoundKey(q, _rk[10]);
+    for (int r = 9; r > 0; r--) {
+      invShiftRows(q);
+      invSbox(q);
+      addRoundKey(q, _rk[r]);
+      invMixColumns(q);
+    }
+    invShiftRows(q);
+    invSbox(q);
+    addRoundKey(q, _rk[0]);
+    store(out, q, n);
+
+    in += 16*n; out += 16*n; num_blocks -= n;
+  }
+}
+
+/* ---------------------------------- SHA-256 ---------------------------------- */
+
+static const uint32_t K256[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x, n)   (((x) >> (n)) | ((x) << (32 - (n))))
+#define SIG0(x)      (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define SIG1(x)      (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+// one round, with the 8 working variables renamed (rather than shuffled) from round to round
+#define ROUND(a, b, c, d, e, f, g, h, k, w) do { \
+    uint32_t t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + (g ^ (e & (f ^ g))) + k + w; \
+    d += t1; \
+    h = t1 + (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) | (c & (a | b))); \
+  } while (0)
+
+void SoftSHA256::processBlocks(uint32_t* h, const uint8_t* data, size_t num_blocks) {
+  uint32_t w[16];
+  while (num_blocks > 0) {
+    for (int i = 0; i < 16; i++) {
+      w[i] = ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+      data += 4;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+    for (int i = 0; i < 64; i += 8) {
+      if (i >= 16) {   // message schedule, as a 16 word ring
+        for (int j = 0; j < 8; j++) {
+          int n = (i + j) & 15;
+          w[n] += SIG1(w[(n + 14) & 15]) + w[(n + 9) & 15] + SIG0(w[(n + 1) & 15]);
+        }
+      }
+      const uint32_t* k = &K256[i];
+      const uint32_t* wp = &w[i & 15];
+      ROUND(a, b, c, d, e, f, g, hh, k[0], wp[0]);
+      ROUND(hh, a, b, c, d, e, f, g, k[1], wp[1]);
+      ROUND(g, hh, a, b, c, d, e, f, k[2], wp[2]);
+      ROUND(f, g, hh, a, b, c, d, e, k[3], wp[3]);
+      ROUND(e, f, g, hh, a, b, c, d, k[4], wp[4]);
+      ROUND(d, e, f, g, hh, a, b, c, k[5], wp[5]);
+      ROUND(c, d, e, f, g, hh, a, b, k[6], wp[6]);
+      ROUND(b, c, d, e, f, g, hh, a, k[7], wp[7]);
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+    num_blocks--;
+  }
+}
+
+void SoftSHA256::reset() {
+  static const uint32_t init[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+  memcpy(_h, init, sizeof(_h));
+  _total = 0;
+  _buf_len = 0;
+}
+
+void SoftSHA256::update(const void* data, size_t len) {
+  const uint8_t* sp = (const uint8_t *) data;
+  _total += len;
+  if (_buf_len > 0) {   // top up the partial block first
+    size_t n = 64 - _buf_len;
+    if (n > len) n = len;
+    memcpy(&_buf[_buf_len], sp, n);
+    _buf_len += n; sp += n; len -= n;
+    if (_buf_len < 64) return;
+    processBlocks(_h, _buf, 1);
+    _buf_len = 0;
+  }
+  if (len >= 64) {   // whole blocks, direct from caller's buffer
+    processBlocks(_h, sp, len / 64);
+    sp += len & ~(size_t)63;
+    len &= 63;
+  }
+  memcpy(_buf, sp, len);
+  _buf_len = len;
+}
+
+void SoftSHA256::finalize(void* hash, size_t len) {
+  uint64_t bits = (uint64_t)_total * 8;
+  _buf[_buf_len++] = 0x80;
+  if (_buf_len > 56) {
+    memset(&_buf[_buf_len], 0, 64 - _buf_len);
+    processBlocks(_h, _buf, 1);
+    _buf_len = 0;
+  }
+  memset(&_buf[_buf_len], 0, 56 - _buf_len);
+  for (int i = 0; i < 8; i++) _buf[56 + i] = bits >> (56 - 8*i);
+  processBlocks(_h, _buf, 1);
+
+  uint8_t digest[32];
+  for (int i = 0; i < 8; i++) {
+    digest[i*4] = _h[i] >> 24; digest[i*4 + 1] = _h[i] >> 16; digest[i*4 + 2] = _h[i] >> 8; digest[i*4 + 3] = _h[i];
+  }
+  if (len > sizeof(digest)) len = sizeof(digest);
+  memcpy(hash, digest, len);
+  reset();
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace mesh {
+
+/**
+ * \brief  Constant-time AES-128, for MCUs without AES hardware. No lookup tables, so no key/data dependent memory
+ *         access: the state is bitsliced (one word per bit of each byte), and the S-box is computed as a boolean
+ *         circuit (Boyar-Peralta). Two blocks are processed per pass, in the lower and upper 16 bits of each word.
+ */
+class SoftAES128 {
+  uint16_t _rk[11][8];   // round keys, bitsliced
+
+public:
+  bool setKey(const uint8_t* key, size_t len);
+  void encryptBlock(uint8_t* out, const uint8_t* in) { encryptBlocks(out, in, 1); }
+  void decryptBlock(uint8_t* out, const uint8_t* in) { decryptBlocks(out, in, 1); }
+  void encryptBlocks(uint8_t* out, const uint8_t* in, int num_blocks);
+  void decryptBlocks(uint8_t* out, const uint8_t* in, int num_blocks);
+};
+
+/**
+ * \brief  SHA-256, with the rounds unrolled, and whole blocks hashed straight from the caller's buffer. Plain value
+ *         type, so a part-way state (eg. keyed HMAC pads) can be copied.
+ */
+class SoftSHA256 {
+  uint32_t _h[8];
+  uint8_t _buf[64];
+  uint32_t _total;    // bytes hashed so far
+  uint8_t _buf_len;
+
+  static void processBlocks(uint32_t* h, const uint8_t* data, size_t num_blocks);
+
+public:
+  SoftSHA256() { reset(); }
+
+  void reset();
+  void update(const void* data, size_t len);
+  void finalize(void* hash, size_t len);
+};
+
+}
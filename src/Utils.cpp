@@ -1,6 +1,4 @@
 #include "Utils.h"
-#include <AES.h>
-#include <SHA256.h>
 
 #ifdef ARDUINO
   #include <Arduino.h>
@@ -15,78 +13,158 @@ uint32_t RNG::nextInt(uint32_t _min, uint32_t _max) {
 }
 
 void Utils::sha256(uint8_t *hash, size_t hash_len, const uint8_t* msg, int msg_len) {
-  SHA256 sha;
+  CryptoSHA256 sha;
   sha.update(msg, msg_len);
   sha.finalize(hash, hash_len);
 }
 
 void Utils::sha256(uint8_t *hash, size_t hash_len, const uint8_t* frag1, int frag1_len, const uint8_t* frag2, int frag2_len) {
-  SHA256 sha;
+  CryptoSHA256 sha;
   sha.update(frag1, frag1_len);
   sha.update(frag2, frag2_len);
   sha.finalize(hash, hash_len);
 }
 
+static int encryptBlocks(CryptoAES128& aes, uint8_t* dest, const uint8_t* src, int src_len) {
+  int num_whole = src_len / 16;
+  aes.encryptBlocks(dest, src, num_whole);
+  int len = num_whole * 16;
+  if (src_len > len) {  // remaining partial block
+    uint8_t tmp[16];
+    memset(tmp, 0, 16);
+    memcpy(tmp, &src[len], src_len - len);
+    aes.encryptBlocks(&dest[len], tmp, 1);
+    len += 16;
+  }
+  return len;  // will always be multiple of 16
+}
+
+static int decryptBlocks(CryptoAES128& aes, uint8_t* dest, const uint8_t* src, int src_len) {
+  int num_blocks = (src_len + 15) / 16;
+  aes.decryptBlocks(dest, src, num_blocks);
+  return num_blocks * 16;  // will always be multiple of 16
+}
+
 int Utils::decrypt(const uint8_t* shared_secret, uint8_t* dest, const uint8_t* src, int src_len) {
-  AES128 aes;
-  uint8_t* dp = dest;
-  const uint8_t* sp = src;
+  CryptoAES128 aes;
+  aes.setKey(shared_secret, CIPHER_KEY_SIZE);
+  return decryptBlocks(aes, dest, src, src_len);
+}
 
+int Utils::encrypt(const uint8_t* shared_secret, uint8_t* dest, const uint8_t* src, int src_len) {
+  CryptoAES128 aes;
   aes.setKey(shared_secret, CIPHER_KEY_SIZE);
-  while (sp - src < src_len) {
-    aes.decryptBlock(dp, sp);
-    dp += 16; sp += 16;
-  }
+  return encryptBlocks(aes, dest, src, src_len);
+}
 
-  return sp - src;  // will always be multiple of 16
+int Utils::encryptThenMAC(const uint8_t* shared_secret, uint8_t* dest, const uint8_t* src, int src_len) {
+  CipherContext ctx;
+  ctx.setSecret(shared_secret);
+  return ctx.encryptThenMAC(dest, src, src_len);
 }
 
-int Utils::encrypt(const uint8_t* shared_secret, uint8_t* dest, const uint8_t* src, int src_len) {
-  AES128 aes;
-  uint8_t* dp = dest;
+int Utils::MACThenDecrypt(const uint8_t* shared_secret, uint8_t* dest, const uint8_t* src, int src_len) {
+  CipherContext ctx;
+  ctx.setSecret(shared_secret);
+  return ctx.MACThenDecrypt(dest, src, src_len);
+}
 
-  aes.setKey(shared_secret, CIPHER_KEY_SIZE);
-  while (src_len >= 16) {
-    aes.encryptBlock(dp, src);
-    dp += 16; src += 16; src_len -= 16;
-  }
-  if (src_len > 0) {  // remaining partial block
-    uint8_t tmp[16];
-    memset(tmp, 0, 16);
-    memcpy(tmp, src, src_len);
-    aes.encryptBlock(dp, tmp);
-    dp += 16;
+void CipherContext::setSecret(const uint8_t* shared_secret) {
+  memcpy(_secret, shared_secret, PUB_KEY_SIZE);
+
+  // HMAC key is the full PUB_KEY_SIZE secret, so is always a single (zero padded) block
+  uint8_t pad[64];
+  memset(pad, 0, sizeof(pad));
+  memcpy(pad, shared_secret, PUB_KEY_SIZE);
+  for (int i = 0; i < (int) sizeof(pad); i++) pad[i] ^= 0x36;
+  _inner.reset();
+  _inner.update(pad, sizeof(pad));
+  for (int i = 0; i < (int) sizeof(pad); i++) pad[i] ^= (0x36 ^ 0x5C);
+  _outer.reset();
+  _outer.update(pad, sizeof(pad));
+  memset(pad, 0, sizeof(pad));
+
+  _aes_keyed = false;
+}
+
+CryptoAES128& CipherContext::aes() {
+  if (!_aes_keyed) {
+    _aes.setKey(_secret, CIPHER_KEY_SIZE);
+    _aes_keyed = true;
   }
-  return dp - dest;  // will always be multiple of 16
+  return _aes;
 }
 
-int Utils::encryptThenMAC(const uint8_t* shared_secret, uint8_t* dest, const uint8_t* src, int src_len) {
-  int enc_len = encrypt(shared_secret, dest + CIPHER_MAC_SIZE, src, src_len);
+void CipherContext::calcMAC(uint8_t* mac, const uint8_t* data, int data_len) {
+  uint8_t inner_hash[32];
+  CryptoSHA256 sha = _inner;
+  sha.update(data, data_len);
+  sha.finalize(inner_hash, sizeof(inner_hash));
+
+  sha = _outer;
+  sha.update(inner_hash, sizeof(inner_hash));
+  sha.finalize(mac, CIPHER_MAC_SIZE);
+}
 
-  SHA256 sha;
-  sha.resetHMAC(shared_secret, PUB_KEY_SIZE);
-  sha.update(dest + CIPHER_MAC_SIZE, enc_len);
-  sha.finalizeHMAC(shared_secret, PUB_KEY_SIZE, dest, CIPHER_MAC_SIZE);
+int CipherContext::encrypt(uint8_t* dest, const uint8_t* src, int src_len) {
+  return encryptBlocks(aes(), dest, src, src_len);
+}
 
+int CipherContext::decrypt(uint8_t* dest, const uint8_t* src, int src_len) {
+  return decryptBlocks(aes(), dest, src, src_len);
+}
+
+int CipherContext::encryptThenMAC(uint8_t* dest, const uint8_t* src, int src_len) {
+  int enc_len = encrypt(dest + CIPHER_MAC_SIZE, src, src_len);
+  calcMAC(dest, dest + CIPHER_MAC_SIZE, enc_len);
   return CIPHER_MAC_SIZE + enc_len;
 }
 
-int Utils::MACThenDecrypt(const uint8_t* shared_secret, uint8_t* dest, const uint8_t* src, int src_len) {
-  if (src_len <= CIPHER_MAC_SIZE) return 0;  // invalid src bytes
+bool CipherContext::verifyMAC(const uint8_t* src, int src_len) {
+  if (src_len <= CIPHER_MAC_SIZE) return false;  // invalid src bytes
 
   uint8_t hmac[CIPHER_MAC_SIZE];
-  {
-    SHA256 sha;
-    sha.resetHMAC(shared_secret, PUB_KEY_SIZE);
-    sha.update(src + CIPHER_MAC_SIZE, src_len - CIPHER_MAC_SIZE);
-    sha.finalizeHMAC(shared_secret, PUB_KEY_SIZE, hmac, CIPHER_MAC_SIZE);
-  }
-  if (memcmp(hmac, src, CIPHER_MAC_SIZE) == 0) {
-    return decrypt(shared_secret, dest, src + CIPHER_MAC_SIZE, src_len - CIPHER_MAC_SIZE);
+  calcMAC(hmac, src + CIPHER_MAC_SIZE, src_len - CIPHER_MAC_SIZE);
+  return memcmp(hmac, src, CIPHER_MAC_SIZE) == 0;
+}
+
+int CipherContext::MACThenDecrypt(uint8_t* dest, const uint8_t* src, int src_len) {
+  if (verifyMAC(src, src_len)) {
+    return decrypt(dest, src + CIPHER_MAC_SIZE, src_len - CIPHER_MAC_SIZE);
   }
   return 0; // invalid HMAC
 }
 
+CipherContextCache::CipherContextCache(int size) {
+  _size = size > 0 ? size : 1;
+  _ctx = NULL;    // allocated on first use, so nodes that never use a given cache don't pay for it
+  _last_used = NULL;
+  _counter = 0;
+  resetStats();
+}
+
+CipherContext& CipherContextCache::get(const uint8_t* shared_secret) {
+  if (_ctx == NULL) {
+    _ctx = new CipherContext[_size];
+    _last_used = new uint32_t[_size];
+    for (int i = 0; i < _size; i++) _last_used[i] = 0;   // 0 = empty slot
+  }
+  _counter++;
+  int lru = 0;
+  for (int i = 0; i < _size; i++) {
+    if (_last_used[i] && _ctx[i].isFor(shared_secret)) {
+      _last_used[i] = _counter;
+      _n_hits++;
+      return _ctx[i];
+    }
+    if ((int32_t)(_last_used[i] - _last_used[lru]) < 0 || _last_used[i] == 0) lru = i;
+  }
+  _n_misses++;
+  _ctx[lru].setSecret(shared_secret);
+  _last_used[lru] = _counter;
+  return _ctx[lru];
+}
+
 static const char hex_chars[] = "0123456789ABCDEF";
 
 void Utils::toHex(char* dest, const uint8_t* src, size_t len) {
@@ -3,6 +3,7 @@
 #include <MeshCore.h>
 #include <Stream.h>
 #include <string.h>
+#include "CryptoBackend.h"
 
 namespace mesh {
 
@@ -16,6 +17,58 @@ public:
   uint32_t nextInt(uint32_t _min, uint32_t _max);
 };
 
+/**
+ * \brief  The keyed crypto state for one shared secret: the HMAC-SHA256 inner/outer states (after absorbing the
+ *         padded key), and the AES128 key schedule (expanded on first use, as MAC checks often fail on candidates).
+ *         Uses the CryptoAES128/CryptoSHA256 of the selected MESH_CRYPTO_BACKEND.
+ *         Same wire format as Utils::encryptThenMAC() / MACThenDecrypt().
+ *         NOTE: not copyable (AES128 points into itself)
+ */
+class CipherContext {
+  uint8_t _secret[PUB_KEY_SIZE];
+  CryptoSHA256 _inner, _outer;
+  CryptoAES128 _aes;
+  bool _aes_keyed;
+
+  CryptoAES128& aes();
+
+public:
+  void setSecret(const uint8_t* shared_secret);
+  bool isFor(const uint8_t* shared_secret) const { return memcmp(_secret, shared_secret, PUB_KEY_SIZE) == 0; }
+
+  void calcMAC(uint8_t* mac, const uint8_t* data, int data_len);
+
+  /**
+   * \returns  true if the MAC at start of 'src' (MAC + encrypted data) is valid for this secret. No decryption done.
+   */
+  bool verifyMAC(const uint8_t* src, int src_len);
+  int encrypt(uint8_t* dest, const uint8_t* src, int src_len);
+  int decrypt(uint8_t* dest, const uint8_t* src, int src_len);
+  int encryptThenMAC(uint8_t* dest, const uint8_t* src, int src_len);
+  int MACThenDecrypt(uint8_t* dest, const uint8_t* src, int src_len);
+};
+
+/**
+ * \brief  Small LRU cache of CipherContexts, keyed by the shared secret, so that repeat traffic with the same
+ *         peers/channels skips the AES key expansion and HMAC key setup.
+ */
+class CipherContextCache {
+  CipherContext* _ctx;
+  uint32_t* _last_used;
+  int _size;
+  uint32_t _counter;
+  uint32_t _n_hits, _n_misses;
+
+public:
+  CipherContextCache(int size);
+
+  CipherContext& get(const uint8_t* shared_secret);
+
+  uint32_t getNumHits() const { return _n_hits; }
+  uint32_t getNumMisses() const { return _n_misses; }
+  void resetStats() { _n_hits = _n_misses = 0; }
+};
+
 class Utils {
 public:
   /**
@@ -1,13 +1,8 @@
 #include "ArduinoSerialInterface.h"
 
-#define RECV_STATE_IDLE        0
-#define RECV_STATE_HDR_FOUND   1
-#define RECV_STATE_LEN1_FOUND  2
-#define RECV_STATE_LEN2_FOUND  3
-
 void ArduinoSerialInterface::enable() { 
   _isEnabled = true;
-  _state = RECV_STATE_IDLE;
+  _parser.reset();
 }
 void ArduinoSerialInterface::disable() {
   _isEnabled = false;
@@ -22,6 +17,14 @@ bool ArduinoSerialInterface::isWriteBusy() const {
 }
 
 size_t ArduinoSerialInterface::writeFrame(const uint8_t src[], size_t len) {
+  const uint8_t* parts[1] = { src };
+  return writeFrameParts(parts, &len, 1);
+}
+
+size_t ArduinoSerialInterface::writeFrameParts(const uint8_t* const parts[], const size_t lens[], int num_parts) {
+  size_t len = 0;
+  for (int i = 0; i < num_parts; i++) len += lens[i];
+
   if (len > MAX_FRAME_SIZE) {
     // frame is too big!
     return 0;
@@ -33,7 +36,11 @@ size_t ArduinoSerialInterface::writeFrame(const uint8_t src[], size_t len) {
   hdr[2] = (len >> 8);    // MSB
 
   _serial->write(hdr, 3);
-  return _serial->write(src, len);
+  size_t n = 0;
+  for (int i = 0; i < num_parts; i++) {   // (no queue, the Stream buffers it)
+    n += _serial->write(parts[i], lens[i]);
+  }
+  return n;
 }
 
 size_t ArduinoSerialInterface::checkRecvFrame(uint8_t dest[]) {
@@ -41,33 +48,8 @@ size_t ArduinoSerialInterface::checkRecvFrame(uint8_t dest[]) {
     int c = _serial->read();
     if (c < 0) break;
 
-    switch (_state) {
-      case RECV_STATE_IDLE:
-        if (c == '<') {
-          _state = RECV_STATE_HDR_FOUND;
-        }
-        break;
-      case RECV_STATE_HDR_FOUND:
-        _frame_len = (uint8_t)c;   // LSB
-        _state = RECV_STATE_LEN1_FOUND;
-        break;
-      case RECV_STATE_LEN1_FOUND:
-        _frame_len |= ((uint16_t)c) << 8;   // MSB
-        rx_len = 0;
-        _state = _frame_len > 0 ? RECV_STATE_LEN2_FOUND : RECV_STATE_IDLE;
-        break;
-      default:
-        if (rx_len < MAX_FRAME_SIZE) {
-          rx_buf[rx_len] = (uint8_t)c;   // rest of frame will be discarded if > MAX
-        }
-        rx_len++;
-        if (rx_len >= _frame_len) {  // received a complete frame?
-          if (_frame_len > MAX_FRAME_SIZE) _frame_len = MAX_FRAME_SIZE;    // truncate
-          memcpy(dest, rx_buf, _frame_len);
-          _state = RECV_STATE_IDLE;  // reset state, for next frame
-          return _frame_len;
-        }
-    }
+    size_t len = _parser.feed((uint8_t)c, dest);
+    if (len > 0) return len;   // received a complete frame
   }
   return 0;
 }
@@ -1,18 +1,16 @@
 #pragma once
 
 #include "BaseSerialInterface.h"
+#include "FrameParser.h"
 #include <Arduino.h>
 
 class ArduinoSerialInterface : public BaseSerialInterface {
   bool _isEnabled;
-  uint8_t _state;
-  uint16_t _frame_len;
-  uint16_t rx_len;
+  FrameParser _parser;
   Stream* _serial;
-  uint8_t rx_buf[MAX_FRAME_SIZE];
 
 public:
-  ArduinoSerialInterface() { _isEnabled = false; _state = 0; }
+  ArduinoSerialInterface() { _isEnabled = false; }
 
   void begin(Stream& serial) { 
     _serial = &serial; 
@@ -30,5 +28,6 @@ public:
 
   bool isWriteBusy() const override;
   size_t writeFrame(const uint8_t src[], size_t len) override;
+  size_t writeFrameParts(const uint8_t* const parts[], const size_t lens[], int num_parts) override;
   size_t checkRecvFrame(uint8_t dest[]) override;
 };
\ No newline at end of file
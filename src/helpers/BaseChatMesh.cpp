@@ -48,6 +48,22 @@ void BaseChatMesh::sendAckTo(const ContactInfo& dest, uint32_t ack_hash) {
   }
 }
 
+ContactInfo* BaseChatMesh::findContact(const mesh::Identity& id) {
+  for (int i = contacts_index.first(id.pub_key[0]); i >= 0; i = contacts_index.next(i)) {
+    if (id.matches(contacts[i].id)) return &contacts[i];
+  }
+  return NULL;  // not found
+}
+
+bool BaseChatMesh::isStaleAdvert(const mesh::Identity& id, uint32_t timestamp) {
+  ContactInfo* c = findContact(id);
+  if (c && timestamp <= c->last_advert_timestamp) {  // check for replay attacks!!
+    MESH_DEBUG_PRINTLN("isStaleAdvert: Possible replay attack, name: %s", c->name);
+    return true;
+  }
+  return false;
+}
+
 void BaseChatMesh::onAdvertRecv(mesh::Packet* packet, const mesh::Identity& id, uint32_t timestamp, const uint8_t* app_data, size_t app_data_len) {
   AdvertDataParser parser(app_data, app_data_len);
   if (!(parser.isValid() && parser.hasName())) {
@@ -55,16 +71,10 @@ void BaseChatMesh::onAdvertRecv(mesh::Packet* packet, const mesh::Identity& id,
     return;
   }
 
-  ContactInfo* from = NULL;
-  for (int i = 0; i < num_contacts; i++) {
-    if (id.matches(contacts[i].id)) {  // is from one of our contacts
-      from = &contacts[i];
-      if (timestamp <= from->last_advert_timestamp) {  // check for replay attacks!!
-        MESH_DEBUG_PRINTLN("onAdvertRecv: Possible replay attack, name: %s", from->name);
-        return;
-      }
-      break;
-    }
+  ContactInfo* from = findContact(id);   // is from one of our contacts?
+  if (from && timestamp <= from->last_advert_timestamp) {  // check for replay attacks!!
+    MESH_DEBUG_PRINTLN("onAdvertRecv: Possible replay attack, name: %s", from->name);
+    return;
   }
 
   // save a copy of raw advert packet (to support "Share..." function)
@@ -94,6 +104,7 @@ void BaseChatMesh::onAdvertRecv(mesh::Packet* packet, const mesh::Identity& id,
     if (num_contacts < MAX_CONTACTS) {
       from = &contacts[num_contacts++];
       from->id = id;
+      contacts_index.add(num_contacts - 1, id.pub_key[0]);
       from->out_path_len = -1;  // initially out_path is unknown
       from->gps_lat = 0;   // initially unknown GPS loc
       from->gps_lon = 0;
@@ -122,7 +133,7 @@ void BaseChatMesh::onAdvertRecv(mesh::Packet* packet, const mesh::Identity& id,
 
 int BaseChatMesh::searchPeersByHash(const uint8_t* hash) {
   int n = 0;
-  for (int i = 0; i < num_contacts && n < MAX_SEARCH_RESULTS; i++) {
+  for (int i = contacts_index.first(hash[0]); i >= 0 && n < MAX_SEARCH_RESULTS; i = contacts_index.next(i)) {
     if (contacts[i].id.isHashMatch(hash)) {
       matching_peer_indexes[n++] = i;  // store the INDEXES of matching contacts (for subsequent 'peer' methods)
     }
@@ -140,6 +151,14 @@ void BaseChatMesh::getPeerSharedSecret(uint8_t* dest_secret, int peer_idx) {
   }
 }
 
+bool BaseChatMesh::getKnownSharedSecret(uint8_t* dest_secret, const mesh::Identity& peer) {
+  ContactInfo* c = findContact(peer);
+  if (c == NULL) return false;  // not a contact
+
+  memcpy(dest_secret, c->shared_secret, PUB_KEY_SIZE);
+  return true;
+}
+
 void BaseChatMesh::onPeerDataRecv(mesh::Packet* packet, uint8_t type, int sender_idx, const uint8_t* secret, uint8_t* data, size_t len) {
   int i = matching_peer_indexes[sender_idx];
   if (i < 0 || i >= num_contacts) {
@@ -284,14 +303,8 @@ void BaseChatMesh::handleReturnPathRetry(const ContactInfo& contact, const uint8
 }
 
 #ifdef MAX_GROUP_CHANNELS
-int BaseChatMesh::searchChannelsByHash(const uint8_t* hash, mesh::GroupChannel dest[], int max_matches) {
-  int n = 0;
-  for (int i = 0; i < MAX_GROUP_CHANNELS && n < max_matches; i++) {
-    if (channels[i].channel.hash[0] == hash[0]) {
-      dest[n++] = channels[i].channel;
-    }
-  }
-  return n;
+int BaseChatMesh::searchChannelsByHash(const uint8_t* hash, int prev_idx) {
+  return prev_idx < 0 ? channels_index.first(hash[0]) : channels_index.next(prev_idx);
 }
 #endif
 
@@ -675,17 +688,20 @@ ContactInfo* BaseChatMesh::searchContactsByPrefix(const char* name_prefix) {
 }
 
 ContactInfo* BaseChatMesh::lookupContactByPubKey(const uint8_t* pub_key, int prefix_len) {
-  for (int i = 0; i < num_contacts; i++) {
-    auto c = &contacts[i];
-    if (memcmp(c->id.pub_key, pub_key, prefix_len) == 0) return c;
+  if (prefix_len > 0) {
+    for (int i = contacts_index.first(pub_key[0]); i >= 0; i = contacts_index.next(i)) {
+      if (memcmp(contacts[i].id.pub_key, pub_key, prefix_len) == 0) return &contacts[i];
+    }
+    return NULL;  // not found
   }
-  return NULL;  // not found
+  return num_contacts > 0 ? &contacts[0] : NULL;  // empty prefix matches any
 }
 
 bool BaseChatMesh::addContact(const ContactInfo& contact) {
   if (num_contacts < MAX_CONTACTS) {
     auto dest = &contacts[num_contacts++];
     *dest = contact;
+    contacts_index.add(num_contacts - 1, contact.id.pub_key[0]);
 
     // calc the ECDH shared secret (just once for performance)
     self_id.calcSharedSecret(dest->shared_secret, contact.id);
@@ -696,11 +712,9 @@ bool BaseChatMesh::addContact(const ContactInfo& contact) {
 }
 
 bool BaseChatMesh::removeContact(ContactInfo& contact) {
-  int idx = 0;
-  while (idx < num_contacts && !contacts[idx].id.matches(contact.id)) {
-    idx++;
-  }
-  if (idx >= num_contacts) return false;   // not found
+  ContactInfo* c = findContact(contact.id);
+  if (c == NULL) return false;   // not found
+  int idx = c - contacts;
 
   // remove from contacts array
   num_contacts--;
@@ -708,6 +722,7 @@ bool BaseChatMesh::removeContact(ContactInfo& contact) {
     contacts[idx] = contacts[idx + 1];
     idx++;
   }
+  contacts_index.rebuild(num_contacts, [this](int i) { return contacts[i].id.pub_key[0]; });   // indexes have shifted
   return true;  // Success
 }
 
@@ -717,12 +732,14 @@ bool BaseChatMesh::removeContact(ContactInfo& contact) {
 ChannelDetails* BaseChatMesh::addChannel(const char* name, const char* psk_base64) {
   if (num_channels < MAX_GROUP_CHANNELS) {
     auto dest = &channels[num_channels];
+    channels_index.remove(num_channels, dest->channel.hash[0]);   // slot may already be in use, via setChannel()
 
     memset(dest->channel.secret, 0, sizeof(dest->channel.secret));
     int len = decode_base64((unsigned char *) psk_base64, strlen(psk_base64), dest->channel.secret);
     if (len == 32 || len == 16) {
       mesh::Utils::sha256(dest->channel.hash, sizeof(dest->channel.hash), dest->channel.secret, len);
       StrHelper::strncpy(dest->name, name, sizeof(dest->name));
+      channels_index.add(num_channels, dest->channel.hash[0]);
       num_channels++;
       return dest;
     }
@@ -740,12 +757,16 @@ bool BaseChatMesh::setChannel(int idx, const ChannelDetails& src) {
   static uint8_t zeroes[] = { 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0 };
 
   if (idx >= 0 && idx < MAX_GROUP_CHANNELS) {
+    channels_index.remove(idx, channels[idx].channel.hash[0]);   // (no-op if slot was empty)
     channels[idx] = src;
     if (memcmp(&src.channel.secret[16], zeroes, 16) == 0) {
       mesh::Utils::sha256(channels[idx].channel.hash, sizeof(channels[idx].channel.hash), src.channel.secret, 16);  // 128-bit key
     } else {
       mesh::Utils::sha256(channels[idx].channel.hash, sizeof(channels[idx].channel.hash), src.channel.secret, 32);  // 256-bit key
     }
+    if (memcmp(src.channel.secret, zeroes, 16) != 0) {   // don't index empty slots
+      channels_index.add(idx, channels[idx].channel.hash[0]);
+    }
     return true;
   }
   return false;
@@ -4,6 +4,7 @@
 #include <Mesh.h>
 #include <helpers/AdvertDataHelpers.h>
 #include <helpers/TxtDataHelpers.h>
+#include <helpers/PeerHashIndex.h>
 
 #define MAX_TEXT_LEN    (10*CIPHER_BLOCK_SIZE)  // must be LESS than (MAX_PACKET_PAYLOAD - 4 - CIPHER_MAC_SIZE - 1)
 
@@ -31,6 +32,11 @@ class ContactsIterator {
   int next_idx = 0;
 public:
   bool hasNext(const BaseChatMesh* mesh, ContactInfo& dest);
+
+  /**
+   * \brief  un-does the last hasNext(), so that the same contact is returned again next time
+   */
+  void putBack() { if (next_idx > 0) next_idx--; }
 };
 
 #ifndef MAX_CONTACTS
@@ -60,12 +66,14 @@ class BaseChatMesh : public mesh::Mesh {
 
   ContactInfo contacts[MAX_CONTACTS];
   int num_contacts;
+  PeerHashIndex<MAX_CONTACTS> contacts_index;   // by pub_key[0]
   int sort_array[MAX_CONTACTS];
   int matching_peer_indexes[MAX_SEARCH_RESULTS];
   unsigned long txt_send_timeout;
 #ifdef MAX_GROUP_CHANNELS
   ChannelDetails channels[MAX_GROUP_CHANNELS];
   int num_channels;  // only for addChannel()
+  PeerHashIndex<MAX_GROUP_CHANNELS> channels_index;   // by channel.hash[0], of non-empty slots only
 #endif
   mesh::Packet* _pendingLoopback;
   uint8_t temp_buf[MAX_TRANS_UNIT];
@@ -73,6 +81,7 @@ class BaseChatMesh : public mesh::Mesh {
 
   mesh::Packet* composeMsgPacket(const ContactInfo& recipient, uint32_t timestamp, uint8_t attempt, const char *text, uint32_t& expected_ack);
   void sendAckTo(const ContactInfo& dest, uint32_t ack_hash);
+  ContactInfo* findContact(const mesh::Identity& id);
 
 protected:
   BaseChatMesh(mesh::Radio& radio, mesh::MillisecondClock& ms, mesh::RNG& rng, mesh::RTCClock& rtc, mesh::PacketManager& mgr, mesh::MeshTables& tables)
@@ -88,7 +97,7 @@ protected:
     memset(connections, 0, sizeof(connections));
   }
 
-  void resetContacts() { num_contacts = 0; }
+  void resetContacts() { num_contacts = 0; contacts_index.clear(); }
 
   // 'UI' concepts, for sub-classes to implement
   virtual bool isAutoAddEnabled() const { return true; }
@@ -112,14 +121,17 @@ protected:
   virtual bool putBlobByKey(const uint8_t key[], int key_len, const uint8_t src_buf[], int len) { return false; }
 
   // Mesh overrides
+  bool isStaleAdvert(const mesh::Identity& id, uint32_t timestamp) override;
   void onAdvertRecv(mesh::Packet* packet, const mesh::Identity& id, uint32_t timestamp, const uint8_t* app_data, size_t app_data_len) override;
   int searchPeersByHash(const uint8_t* hash) override;
   void getPeerSharedSecret(uint8_t* dest_secret, int peer_idx) override;
+  bool getKnownSharedSecret(uint8_t* dest_secret, const mesh::Identity& peer) override;
   void onPeerDataRecv(mesh::Packet* packet, uint8_t type, int sender_idx, const uint8_t* secret, uint8_t* data, size_t len) override;
   bool onPeerPathRecv(mesh::Packet* packet, int sender_idx, const uint8_t* secret, uint8_t* path, uint8_t path_len, uint8_t extra_type, uint8_t* extra, uint8_t extra_len) override;
   void onAckRecv(mesh::Packet* packet, uint32_t ack_crc) override;
 #ifdef MAX_GROUP_CHANNELS
-  int searchChannelsByHash(const uint8_t* hash, mesh::GroupChannel channels[], int max_matches) override;
+  int searchChannelsByHash(const uint8_t* hash, int prev_idx) override;
+  const mesh::GroupChannel* getGroupChannel(int idx) override { return &channels[idx].channel; }
 #endif
   void onGroupDataRecv(mesh::Packet* packet, uint8_t type, const mesh::GroupChannel& channel, uint8_t* data, size_t len) override;
 
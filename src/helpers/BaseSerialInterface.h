@@ -1,9 +1,24 @@
 #pragma once
 
 #include <Arduino.h>
+#include "FrameQueue.h"
 
 #define MAX_FRAME_SIZE  172
 
+// sizes of the FrameQueue byte rings, in queued implementations (variants can override)
+#ifndef SERIAL_SEND_QUEUE_BYTES
+  #if defined(ESP32)
+    #define SERIAL_SEND_QUEUE_BYTES   4096
+  #elif defined(NRF52_PLATFORM)
+    #define SERIAL_SEND_QUEUE_BYTES   2048
+  #else
+    #define SERIAL_SEND_QUEUE_BYTES   1024
+  #endif
+#endif
+#ifndef SERIAL_RECV_QUEUE_BYTES
+  #define SERIAL_RECV_QUEUE_BYTES   1024
+#endif
+
 class BaseSerialInterface {
 protected:
   BaseSerialInterface() { }
@@ -18,4 +33,44 @@ public:
   virtual bool isWriteBusy() const = 0;
   virtual size_t writeFrame(const uint8_t src[], size_t len) = 0;
   virtual size_t checkRecvFrame(uint8_t dest[]) = 0;
+
+  /**
+   * \brief  scatter-gather version of writeFrame(). Writes ONE frame made from the 'num_parts' pieces, eg. a header
+   *         and a payload, without the caller assembling them into a buffer first.
+   *         Default assembles them here, for implementations that don't queue (or write) the parts directly.
+   */
+  virtual size_t writeFrameParts(const uint8_t* const parts[], const size_t lens[], int num_parts) {
+    uint8_t frame[MAX_FRAME_SIZE];
+    size_t len = 0;
+    for (int i = 0; i < num_parts; i++) {
+      if (len + lens[i] > MAX_FRAME_SIZE) return 0;   // frame is too big!
+      memcpy(&frame[len], parts[i], lens[i]);
+      len += lens[i];
+    }
+    return writeFrame(frame, len);
+  }
+
+  /**
+   * \brief  which push frames (codes 0x80..0x9F, one bit each from bit 0) the app that sent the latest received
+   *         frame wants. For interfaces with several apps connected at once.
+   * \returns  false if not supported, ie. every app gets every push
+   */
+  virtual bool setPushMask(uint32_t mask) { return false; }
+
+  /**
+   * \returns  id of the app that replies currently go to (the one that sent the latest received frame), so that a
+   *           multi-frame reply can be kept to it with setReplySession(). Always 0 where only one app can connect.
+   */
+  virtual uint32_t getReplySession() const { return 0; }
+
+  /**
+   * \brief  sends replies to app 'session' (from getReplySession()), until the next frame is received
+   * \returns  false if that app is no longer connected
+   */
+  virtual bool setReplySession(uint32_t session) { return session == 0; }
+
+  /**
+   * \returns  false if this interface doesn't queue outgoing frames
+   */
+  virtual bool getSendQueueStats(FrameQueueStats& stats) const { return false; }
 };
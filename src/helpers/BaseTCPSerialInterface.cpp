@@ -0,0 +1,228 @@
+#include "BaseTCPSerialInterface.h"
+
+#define FRAME_HDR_SIZE     4    // session bits, then '>' len LSB, len MSB (same header as serial interface)
+#define FRAME_MAX_PARTS    4
+
+BaseTCPSerialInterface::BaseTCPSerialInterface() {
+  for (int i = 0; i < TCP_MAX_CLIENTS; i++) {
+    _sessions[i].active = false;
+  }
+  _num_pushed = _num_popped = 0;
+  _head_pending = -1;
+  _curr_session = -1;
+  _next_session_id = 1;   // (0 = none)
+  _next_read = 0;
+  _isEnabled = false;
+}
+
+// ---------- public methods
+
+void BaseTCPSerialInterface::enable() {
+  if (_isEnabled) return;
+
+  _isEnabled = true;
+  _send_queue.clear();
+  _num_popped = _num_pushed;
+  _head_pending = -1;
+}
+
+void BaseTCPSerialInterface::disable() {
+  _isEnabled = false;
+  for (int i = 0; i < TCP_MAX_CLIENTS; i++) {
+    if (_sessions[i].active) endSession(i);
+  }
+}
+
+bool BaseTCPSerialInterface::isConnected() const {
+  return getNumClients() > 0;
+}
+
+int BaseTCPSerialInterface::getNumClients() const {
+  int n = 0;
+  for (int i = 0; i < TCP_MAX_CLIENTS; i++) {
+    if (_sessions[i].active) n++;
+  }
+  return n;
+}
+
+bool BaseTCPSerialInterface::isWriteBusy() const {
+  return _send_queue.bytesUsed() > SERIAL_SEND_QUEUE_BYTES - 2*(FRAME_HDR_SIZE + 1 + MAX_FRAME_SIZE);   // keep room for replies
+}
+
+size_t BaseTCPSerialInterface::writeFrame(const uint8_t src[], size_t len) {
+  const uint8_t* parts[1] = { src };
+  return writeFrameParts(parts, &len, 1);
+}
+
+size_t BaseTCPSerialInterface::writeFrameParts(const uint8_t* const parts[], const size_t lens[], int num_parts) {
+  size_t len = 0;
+  int code = -1;
+  for (int i = 0; i < num_parts; i++) {
+    if (code < 0 && lens[i] > 0) code = parts[i][0];
+    len += lens[i];
+  }
+  if (len == 0 || len > MAX_FRAME_SIZE || num_parts >= FRAME_MAX_PARTS) {   // (one part is needed for header)
+    TCP_DEBUG_PRINTLN("writeFrame(), bad frame, len=%d", len);
+    return 0;
+  }
+
+  uint8_t dest_bits = 0;
+  if (code >= 0x80) {   // push, to whoever subscribes to it
+    for (int i = 0; i < TCP_MAX_CLIENTS; i++) {
+      const Session& s = _sessions[i];
+      if (s.active && (code - 0x80 >= 32 || (s.push_mask & (1UL << (code - 0x80))))) dest_bits |= (1 << i);
+    }
+  } else if (_curr_session >= 0) {   // reply, to the one that sent the command
+    dest_bits = 1 << _curr_session;
+  }
+  if (dest_bits == 0) return 0;
+
+  uint8_t hdr[FRAME_HDR_SIZE];
+  hdr[0] = dest_bits;
+  hdr[1] = '>';
+  hdr[2] = (len & 0xFF);  // LSB
+  hdr[3] = (len >> 8);    // MSB
+
+  const uint8_t* all_parts[FRAME_MAX_PARTS];
+  size_t all_lens[FRAME_MAX_PARTS];
+  all_parts[0] = hdr; all_lens[0] = FRAME_HDR_SIZE;
+  for (int i = 0; i < num_parts; i++) {
+    all_parts[i + 1] = parts[i];
+    all_lens[i + 1] = lens[i];
+  }
+  if (!_send_queue.push(all_parts, all_lens, num_parts + 1)) {
+    TCP_DEBUG_PRINTLN("writeFrame(), send_queue is full!");
+    return 0;
+  }
+  _num_pushed++;
+  return len;
+}
+
+bool BaseTCPSerialInterface::setReplySession(uint32_t session) {
+  for (int i = 0; i < TCP_MAX_CLIENTS; i++) {
+    if (_sessions[i].active && _sessions[i].id == session) {
+      _curr_session = i;
+      return true;
+    }
+  }
+  return false;   // has disconnected
+}
+
+bool BaseTCPSerialInterface::setPushMask(uint32_t mask) {
+  if (_curr_session < 0) return false;
+
+  _sessions[_curr_session].push_mask = mask;
+  return true;
+}
+
+size_t BaseTCPSerialInterface::checkRecvFrame(uint8_t dest[]) {
+  if (!_isEnabled) return 0;
+
+  acceptClients();
+  writeQueued();
+  return readClients(dest);
+}
+
+// ---------- sessions
+
+void BaseTCPSerialInterface::acceptClients() {
+  for (;;) {
+    int idx = 0;
+    while (idx < TCP_MAX_CLIENTS && _sessions[idx].active) idx++;
+    if (idx == TCP_MAX_CLIENTS) idx = -1;   // all slots taken
+
+    if (!acceptClient(idx)) break;
+
+    Session& s = _sessions[idx];
+    s.active = true;
+    s.id = _next_session_id++;
+    if (_next_session_id == 0) _next_session_id = 1;
+    s.parser.reset();
+    s.push_mask = PUSH_MASK_ALL;
+    s.write_pos = 0;
+    s.stalled_since = 0;
+    s.first_seq = _num_pushed;
+    if (_head_pending > 0) _head_pending &= ~(1 << idx);   // joined part way through head frame
+    TCP_DEBUG_PRINTLN("client %d connected", idx);
+  }
+}
+
+void BaseTCPSerialInterface::endSession(int idx) {
+  closeClient(idx);
+  _sessions[idx].active = false;
+  if (_head_pending > 0) _head_pending &= ~(1 << idx);
+  if (_curr_session == idx) _curr_session = -1;
+  TCP_DEBUG_PRINTLN("client %d disconnected", idx);
+}
+
+void BaseTCPSerialInterface::writeQueued() {
+  const uint8_t* frame;
+  size_t len;
+  while ((frame = _send_queue.peek(len)) != NULL) {
+    if (_head_pending < 0) {   // new head frame
+      _head_pending = frame[0];
+      for (int i = 0; i < TCP_MAX_CLIENTS; i++) {
+        const Session& s = _sessions[i];
+        if (!s.active || (int32_t)(_num_popped - s.first_seq) < 0) _head_pending &= ~(1 << i);
+      }
+    }
+    const uint8_t* data = &frame[1];   // same bytes, for every client
+    size_t data_len = len - 1;
+    for (int i = 0; i < TCP_MAX_CLIENTS; i++) {
+      if ((_head_pending & (1 << i)) == 0) continue;
+
+      Session& s = _sessions[i];
+      int n = writeClient(i, &data[s.write_pos], data_len - s.write_pos);
+      if (n < 0) {
+        endSession(i);
+        continue;
+      }
+      s.write_pos += n;
+      if (s.write_pos >= data_len) {   // this client is done with it
+        s.write_pos = 0;
+        s.stalled_since = 0;
+        _head_pending &= ~(1 << i);
+      } else if (n > 0 || s.stalled_since == 0) {
+        s.stalled_since = millis();
+      } else if (millis() - s.stalled_since > TCP_CLIENT_STALL_MILLIS) {
+        TCP_DEBUG_PRINTLN("client %d stalled", i);
+        endSession(i);
+      }
+    }
+    if (_head_pending != 0) break;   // still waiting on some, try again next time
+
+    _send_queue.pop();
+    _num_popped++;
+    _head_pending = -1;
+  }
+}
+
+size_t BaseTCPSerialInterface::readClients(uint8_t dest[]) {
+  uint8_t buf[MAX_FRAME_SIZE];
+  for (int k = 0; k < TCP_MAX_CLIENTS; k++) {
+    int idx = (_next_read + k) % TCP_MAX_CLIENTS;
+    Session& s = _sessions[idx];
+    if (!s.active) continue;
+
+    for (;;) {
+      size_t want = s.parser.wanted();   // (so never reads into the next frame)
+      int n = readClient(idx, buf, want < sizeof(buf) ? want : sizeof(buf));
+      if (n < 0) {
+        endSession(idx);
+        break;
+      }
+      if (n == 0) break;
+
+      size_t len = 0;
+      for (int j = 0; j < n; j++) {
+        len = s.parser.feed(buf[j], dest);
+      }
+      if (len > 0) {   // a complete frame, so replies are for this client
+        _curr_session = idx;
+        _next_read = (idx + 1) % TCP_MAX_CLIENTS;
+        return len;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "BaseSerialInterface.h"
+#include "FrameParser.h"
+
+#ifndef TCP_MAX_CLIENTS
+  #define TCP_MAX_CLIENTS   4      // (max 8)
+#endif
+#ifndef TCP_CLIENT_STALL_MILLIS
+  #define TCP_CLIENT_STALL_MILLIS   5000    // drop a client that has accepted nothing for this long
+#endif
+
+#define PUSH_MASK_ALL   0xFFFFFFFF
+
+/**
+ * \brief  Companion interface for several TCP apps connected at once, eg. a dashboard and a phone. The socket
+ *         calls are left to sub-classes (per platform), this does the sessions:
+ *           - each client has its own FrameParser, so their partial frames don't mix
+ *           - replies (codes < 0x80) go to the client whose frame was received last, ie. which sent the command
+ *             (or as set by setReplySession(), to keep a multi-frame reply to the client that asked for it)
+ *           - pushes (codes >= 0x80) go to every client whose push mask has that code's bit (all, by default)
+ *         Outgoing frames are queued ONCE, in one FrameQueue, with a bit per client they are for, and each client
+ *         is written from that same copy. The queue moves on when all of the head frame's clients have it,
+ *         so a client which stops reading is dropped after TCP_CLIENT_STALL_MILLIS, rather than stall the rest.
+ */
+class BaseTCPSerialInterface : public BaseSerialInterface {
+  static_assert(TCP_MAX_CLIENTS >= 1 && TCP_MAX_CLIENTS <= 8, "TCP_MAX_CLIENTS must be 1..8");
+
+  struct Session {
+    bool active;
+    uint32_t id;                    // unique, so a later client in same slot isn't mistaken for this one
+    FrameParser parser;
+    uint32_t push_mask;
+    uint16_t write_pos;             // bytes of head frame already written, if only partly
+    unsigned long stalled_since;
+    uint32_t first_seq;             // first queued frame that can be for this client (not a previous one in slot)
+  };
+
+  Session _sessions[TCP_MAX_CLIENTS];
+  FrameQueue<SERIAL_SEND_QUEUE_BYTES> _send_queue;   // each: [session bits]['>' len LSB, MSB][frame]
+  uint32_t _num_pushed, _num_popped;   // frame sequence numbers
+  int _head_pending;       // session bits still to write head frame to, or -1 if not loaded yet
+  int _curr_session;       // the one replies go to (or -1)
+  uint32_t _next_session_id;
+  int _next_read;          // round-robin, so one busy client can't starve the others
+  bool _isEnabled;
+
+  void acceptClients();
+  void endSession(int idx);
+  void writeQueued();
+  size_t readClients(uint8_t dest[]);
+
+protected:
+  BaseTCPSerialInterface();
+
+  // transport, implemented per platform. All calls must NOT block.
+
+  /**
+   * \brief  accept a pending connection, if any, as client 'idx'. When idx < 0 (ie. no free slots) just refuse it.
+   * \returns  true if a client was accepted
+   */
+  virtual bool acceptClient(int idx) = 0;
+
+  /**
+   * \returns  bytes read (up to 'max_len'), 0 if none available yet, or -1 if connection closed/failed
+   */
+  virtual int readClient(int idx, uint8_t* dest, size_t max_len) = 0;
+
+  /**
+   * \returns  bytes taken (0 if none, for now), or -1 if connection closed/failed
+   */
+  virtual int writeClient(int idx, const uint8_t* src, size_t len) = 0;
+
+  virtual void closeClient(int idx) = 0;
+
+public:
+  // BaseSerialInterface methods
+  void enable() override;
+  void disable() override;
+  bool isEnabled() const override { return _isEnabled; }
+
+  bool isConnected() const override;
+  bool isWriteBusy() const override;
+
+  size_t writeFrame(const uint8_t src[], size_t len) override;
+  size_t writeFrameParts(const uint8_t* const parts[], const size_t lens[], int num_parts) override;
+  size_t checkRecvFrame(uint8_t dest[]) override;
+  bool setPushMask(uint32_t mask) override;
+  uint32_t getReplySession() const override { return _curr_session < 0 ? 0 : _sessions[_curr_session].id; }
+  bool setReplySession(uint32_t session) override;
+  bool getSendQueueStats(FrameQueueStats& stats) const override { _send_queue.getStats(stats); return true; }
+
+  int getNumClients() const;
+};
+
+#if (TCP_DEBUG_LOGGING || WIFI_DEBUG_LOGGING) && ARDUINO
+  #include <Arduino.h>
+  #define TCP_DEBUG_PRINT(F, ...) Serial.printf("TCP: " F, ##__VA_ARGS__)
+  #define TCP_DEBUG_PRINTLN(F, ...) Serial.printf("TCP: " F "\n", ##__VA_ARGS__)
+#else
+  #define TCP_DEBUG_PRINT(...) {}
+  #define TCP_DEBUG_PRINTLN(...) {}
+#endif
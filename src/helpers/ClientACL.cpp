@@ -13,6 +13,7 @@ static File openWrite(FILESYSTEM* _fs, const char* filename) {
 
 void ClientACL::load(FILESYSTEM* _fs) {
   num_clients = 0;
+  index.clear();
   if (_fs->exists("/s_contacts")) {
   #if defined(RP2040_PLATFORM)
     File file = _fs->open("/s_contacts", "r");
@@ -40,6 +41,7 @@ void ClientACL::load(FILESYSTEM* _fs) {
 
         c.id = mesh::Identity(pub_key);
         if (num_clients < MAX_CLIENTS) {
+          index.add(num_clients, pub_key[0]);
           clients[num_clients++] = c;
         } else {
           full = true;
@@ -75,17 +77,29 @@ void ClientACL::save(FILESYSTEM* _fs, bool (*filter)(ClientInfo*)) {
 }
 
 ClientInfo* ClientACL::getClient(const uint8_t* pubkey, int key_len) {
-  for (int i = 0; i < num_clients; i++) {
+  if (key_len <= 0) return num_clients > 0 ? &clients[0] : NULL;
+
+  for (int i = index.first(pubkey[0]); i >= 0; i = index.next(i)) {
     if (memcmp(pubkey, clients[i].id.pub_key, key_len) == 0) return &clients[i];  // already known
   }
   return NULL;  // not found
 }
 
+int ClientACL::searchByHash(const uint8_t* hash, int dest_indexes[], int max_matches) {
+  int n = 0;
+  for (int i = index.first(hash[0]); i >= 0 && n < max_matches; i = index.next(i)) {
+    if (clients[i].id.isHashMatch(hash)) dest_indexes[n++] = i;
+  }
+  return n;
+}
+
 ClientInfo* ClientACL::putClient(const mesh::Identity& id, uint8_t init_perms) {
+  ClientInfo* known = getClient(id.pub_key, PUB_KEY_SIZE);
+  if (known) return known;
+
   uint32_t min_time = 0xFFFFFFFF;
   ClientInfo* oldest = &clients[MAX_CLIENTS - 1];
   for (int i = 0; i < num_clients; i++) {
-    if (id.matches(clients[i].id)) return &clients[i];  // already known
     if (!clients[i].isAdmin() && clients[i].last_activity < min_time) {
       oldest = &clients[i];
       min_time = oldest->last_activity;
@@ -97,14 +111,24 @@ ClientInfo* ClientACL::putClient(const mesh::Identity& id, uint8_t init_perms) {
     c = &clients[num_clients++];
   } else {
     c = oldest;  // evict least active contact
+    index.remove(c - clients, c->id.pub_key[0]);
   }
   memset(c, 0, sizeof(*c));
   c->permissions = init_perms;
   c->id = id;
+  index.add(c - clients, id.pub_key[0]);
   c->out_path_len = -1;  // initially out_path is unknown
   return c;
 }
 
+bool ClientACL::getSharedSecret(const mesh::Identity& id, uint8_t* dest_secret) {
+  ClientInfo* c = getClient(id.pub_key, PUB_KEY_SIZE);
+  if (c == NULL) return false;
+
+  memcpy(dest_secret, c->shared_secret, PUB_KEY_SIZE);
+  return true;
+}
+
 bool ClientACL::applyPermissions(const mesh::LocalIdentity& self_id, const uint8_t* pubkey, int key_len, uint8_t perms) {
   ClientInfo* c;
   if ((perms & PERM_ACL_ROLE_MASK) == PERM_ACL_GUEST) {  // guest role is not persisted in contacts
@@ -117,6 +141,7 @@ bool ClientACL::applyPermissions(const mesh::LocalIdentity& self_id, const uint8
       clients[i] = clients[i + 1];
       i++;
     }
+    index.rebuild(num_clients, [this](int k) { return clients[k].id.pub_key[0]; });   // indexes have shifted
   } else {
     if (key_len < PUB_KEY_SIZE) return false;   // need complete pubkey when adding/modifying
 
@@ -3,6 +3,7 @@
 #include <Arduino.h>   // needed for PlatformIO
 #include <Mesh.h>
 #include <helpers/IdentityStore.h>
+#include <helpers/PeerHashIndex.h>
 
 #define PERM_ACL_ROLE_MASK     3   // lower 2 bits
 #define PERM_ACL_GUEST         0
@@ -38,16 +39,26 @@ struct ClientInfo {
 class ClientACL {
   ClientInfo clients[MAX_CLIENTS];
   int num_clients;
+  PeerHashIndex<MAX_CLIENTS> index;   // by pub_key[0]
 
 public:
   ClientACL() { 
     memset(clients, 0, sizeof(clients));
     num_clients = 0;
+    index.clear();
   }
   void load(FILESYSTEM* _fs);
   void save(FILESYSTEM* _fs, bool (*filter)(ClientInfo*)=NULL);
 
   ClientInfo* getClient(const uint8_t* pubkey, int key_len);
+  bool getSharedSecret(const mesh::Identity& id, uint8_t* dest_secret);
+
+  /**
+   * \brief  find the clients whose pub_key starts with 'hash' (PATH_HASH_SIZE bytes)
+   * \param  dest_indexes  OUT - the matching indexes (for getClientByIdx())
+   * \returns  number of matches stored in 'dest_indexes'
+   */
+  int searchByHash(const uint8_t* hash, int dest_indexes[], int max_matches);
   ClientInfo* putClient(const mesh::Identity& id, uint8_t init_perms);
   bool applyPermissions(const mesh::LocalIdentity& self_id, const uint8_t* pubkey, int key_len, uint8_t perms);
 
@@ -128,6 +128,62 @@ void CommonCLI::savePrefs() {
   _callbacks->savePrefs();
 }
 
+static const char* latency_stage_names[LATENCY_NUM_STAGES] = { "rxq", "proc", "txq", "air", "total" };
+
+// latency                  -> count/avg/max millis per stage, all payload types
+// latency {type}           -> same, for one payload type
+// latency {type} {stage}   -> histogram for one payload type and stage
+void CommonCLI::formatLatencyReply(const char* args, char* reply) {
+  const mesh::LatencyStats* stats = _callbacks->getLatencyStats();
+  if (stats == NULL) {
+    strcpy(reply, "ERR: not built with MESH_LATENCY_STATS");
+    return;
+  }
+  while (*args == ' ') args++;
+  int type = *args ? _atoi(args) : -1;
+  const char* sp = strchr(args, ' ');
+  int stage = -1;
+  if (sp) {
+    while (*++sp == ' ') ;
+    for (int s = 0; s < LATENCY_NUM_STAGES; s++) {
+      if (strcmp(sp, latency_stage_names[s]) == 0) stage = s;
+    }
+    if (stage < 0 || type < 0) {
+      strcpy(reply, "ERR: latency {type} rxq|proc|txq|air|total");
+      return;
+    }
+  }
+
+  char* dp = reply;
+  if (stage >= 0) {
+    const mesh::LatencyHistogram& h = stats->get(type, stage);
+    for (int b = 0; b < LATENCY_NUM_BUCKETS; b++) {
+      int n;
+      if (b < LATENCY_NUM_BUCKETS - 1) {
+        n = snprintf(dp, &reply[150] - dp, "<%u:%u ", mesh::LatencyHistogram::bucketLimit(b), (uint32_t) h.buckets[b]);
+      } else {
+        n = snprintf(dp, &reply[150] - dp, "more:%u", (uint32_t) h.buckets[b]);
+      }
+      if (n >= &reply[150] - dp) break;   // keep within reply buffer
+      dp += n;
+    }
+    return;
+  }
+  for (int s = 0; s < LATENCY_NUM_STAGES; s++) {   // count/avg/max
+    uint32_t count = 0, total = 0, max_millis = 0;
+    for (int t = 0; t < LATENCY_NUM_TYPES; t++) {
+      if (type >= 0 && t != type) continue;
+      const mesh::LatencyHistogram& h = stats->get(t, s);
+      count += h.count;
+      total += h.total_millis;
+      if (h.max_millis > max_millis) max_millis = h.max_millis;
+    }
+    int n = snprintf(dp, &reply[150] - dp, "%s%s %u/%u/%u", s > 0 ? "\n" : "", latency_stage_names[s], count, count ? total / count : 0, max_millis);
+    if (n >= &reply[150] - dp) break;   // keep within reply buffer
+    dp += n;
+  }
+}
+
 void CommonCLI::handleCommand(uint32_t sender_timestamp, const char* command, char* reply) {
     if (memcmp(command, "reboot", 6) == 0) {
       _board->reboot();  // doesn't return
@@ -199,6 +255,8 @@ void CommonCLI::handleCommand(uint32_t sender_timestamp, const char* command, ch
     } else if (memcmp(command, "clear stats", 11) == 0) {
       _callbacks->clearStats();
       strcpy(reply, "(OK - stats reset)");
+    } else if (memcmp(command, "latency", 7) == 0) {
+      formatLatencyReply(&command[7], reply);
     } else if (memcmp(command, "get ", 4) == 0) {
       const char* config = &command[4];
       if (memcmp(config, "af", 2) == 0) {
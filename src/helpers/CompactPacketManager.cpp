@@ -0,0 +1,208 @@
+#include "CompactPacketManager.h"
+
+#define BLOCK_FREE    0x80
+#define NO_BLOCK    0xFFFF
+
+#define RECORD_HEADER_SIZE   2    // raw_len, snr  (so even max size packets fit in a page)
+
+PacketArena::PacketArena(int num_pages) {
+  _num_units = num_pages << (PACKET_ARENA_NUM_ORDERS - 1);
+  _mem = new uint8_t[num_pages * PACKET_ARENA_PAGE_SIZE];
+  _unit_info = new uint8_t[_num_units];
+  memset(_unit_info, 0, _num_units);
+#if MESH_LATENCY_STATS
+  _timestamps = new uint32_t[_num_units * 2];   // kept out of the records, so they don't push packets up a size class
+#endif
+  for (int i = 0; i < PACKET_ARENA_NUM_ORDERS; i++) _free_head[i] = NO_BLOCK;
+
+  int top = PACKET_ARENA_NUM_ORDERS - 1;
+  for (int p = num_pages - 1; p >= 0; p--) {   // initially, all whole pages
+    pushFree(p << top, top);
+  }
+  _num_stored = _bytes_used = 0;
+  resetStats();
+}
+
+void PacketArena::resetStats() {
+  _high_water_bytes = _bytes_used;
+  _n_store_fails = 0;
+}
+
+void PacketArena::pushFree(int unit, int order) {
+  _unit_info[unit] = BLOCK_FREE | order;
+  linkPrev(unit) = NO_BLOCK;
+  linkNext(unit) = _free_head[order];
+  if (_free_head[order] != NO_BLOCK) linkPrev(_free_head[order]) = unit;
+  _free_head[order] = unit;
+}
+
+void PacketArena::unlinkFree(int unit, int order) {
+  uint16_t prev = linkPrev(unit), next = linkNext(unit);
+  if (prev == NO_BLOCK) {
+    _free_head[order] = next;
+  } else {
+    linkNext(prev) = next;
+  }
+  if (next != NO_BLOCK) linkPrev(next) = prev;
+  _unit_info[unit] = order;
+}
+
+int PacketArena::allocBlock(int order) {
+  int o = order;
+  while (o < PACKET_ARENA_NUM_ORDERS && _free_head[o] == NO_BLOCK) o++;
+  if (o == PACKET_ARENA_NUM_ORDERS) return -1;   // no room
+
+  int unit = _free_head[o];
+  unlinkFree(unit, o);
+  while (o > order) {   // split, putting the upper halves back on the free lists
+    o--;
+    pushFree(unit + (1 << o), o);
+  }
+  _unit_info[unit] = order;
+  return unit;
+}
+
+void PacketArena::freeBlock(int unit) {
+  int order = _unit_info[unit];
+  while (order < PACKET_ARENA_NUM_ORDERS - 1) {   // merge with buddy, while it is also free
+    int buddy = unit ^ (1 << order);
+    if (_unit_info[buddy] != (BLOCK_FREE | order)) break;
+
+    unlinkFree(buddy, order);
+    if (buddy < unit) unit = buddy;
+    order++;
+  }
+  pushFree(unit, order);
+}
+
+uint16_t PacketArena::store(const mesh::Packet* packet) {
+  uint8_t raw[RECORD_HEADER_SIZE + MAX_TRANS_UNIT];
+  uint8_t len = packet->writeTo(&raw[RECORD_HEADER_SIZE]);
+  raw[0] = len;
+  raw[1] = (uint8_t) packet->_snr;
+
+  int sz = RECORD_HEADER_SIZE + len;
+  int order = 0;
+  while ((PACKET_ARENA_UNIT_SIZE << order) < sz) order++;
+
+  int unit = order < PACKET_ARENA_NUM_ORDERS ? allocBlock(order) : -1;
+  if (unit < 0) {
+    _n_store_fails++;
+    return 0;
+  }
+  memcpy(unitPtr(unit), raw, sz);
+#if MESH_LATENCY_STATS
+  _timestamps[unit*2] = packet->_t_origin;
+  _timestamps[unit*2 + 1] = packet->_t_queued;
+#endif
+
+  _num_stored++;
+  _bytes_used += PACKET_ARENA_UNIT_SIZE << order;
+  if (_bytes_used > _high_water_bytes) _high_water_bytes = _bytes_used;
+  return unit + 1;
+}
+
+void PacketArena::load(uint16_t handle, mesh::Packet* dest) const {
+  const uint8_t* rec = unitPtr(handle - 1);
+  dest->readFrom(&rec[RECORD_HEADER_SIZE], rec[0]);
+  dest->_snr = (int8_t) rec[1];
+#if MESH_LATENCY_STATS
+  dest->_t_origin = _timestamps[(handle - 1)*2];
+  dest->_t_queued = _timestamps[(handle - 1)*2 + 1];
+#endif
+}
+
+void PacketArena::release(uint16_t handle) {
+  int unit = handle - 1;
+  _num_stored--;
+  _bytes_used -= PACKET_ARENA_UNIT_SIZE << _unit_info[unit];
+  freeBlock(unit);
+}
+
+CompactPacketManager::CompactPacketManager(int arena_pages, int num_working, int max_queued)
+  : _working(num_working), _arena(arena_pages),
+    _send_queue(max_queued > 0 ? max_queued : arena_pages*4), _rx_queue(max_queued > 0 ? max_queued : arena_pages*4)
+{
+}
+
+void CompactPacketManager::enqueue(ScheduledQueue<uint16_t>& queue, mesh::Packet* packet, uint8_t priority, uint32_t scheduled_for) {
+  uint16_t handle = _arena.store(packet);
+  if (handle == 0) {
+    MESH_DEBUG_PRINTLN("CompactPacketManager: arena full, packet dropped");
+  } else if (!queue.add(handle, priority, scheduled_for)) {
+    _arena.release(handle);
+  }
+  _working.free(packet);
+}
+
+mesh::Packet* CompactPacketManager::dequeue(ScheduledQueue<uint16_t>& queue, uint32_t now) {
+  if (_working.getFreeCount() == 0) return NULL;   // leave it queued until a Packet is free to decode into
+
+  uint16_t handle = queue.get(now);
+  if (handle == 0) return NULL;
+
+  mesh::Packet* packet = _working.alloc();
+  _arena.load(handle, packet);
+  _arena.release(handle);
+  return packet;
+}
+
+mesh::Packet* CompactPacketManager::allocNew() {
+  return _working.alloc();  // returns NULL if empty
+}
+
+void CompactPacketManager::free(mesh::Packet* packet) {
+  _working.free(packet);
+}
+
+void CompactPacketManager::queueOutbound(mesh::Packet* packet, uint8_t priority, uint32_t scheduled_for) {
+  enqueue(_send_queue, packet, priority, scheduled_for);
+}
+
+mesh::Packet* CompactPacketManager::getNextOutbound(uint32_t now) {
+  return dequeue(_send_queue, now);
+}
+
+int CompactPacketManager::getOutboundCount(uint32_t now) const {
+  return _send_queue.countBefore(now);
+}
+
+int CompactPacketManager::getFreeCount() const {
+  return _working.getFreeCount();
+}
+
+mesh::Packet* CompactPacketManager::getOutboundByIdx(int i) {
+  if (i >= _send_queue.count()) return NULL;
+
+  _arena.load(_send_queue.itemAt(i), &_peek);
+  return &_peek;   // only valid until next call
+}
+
+mesh::Packet* CompactPacketManager::removeOutboundByIdx(int i) {
+  if (i >= _send_queue.count() || _working.getFreeCount() == 0) return NULL;
+
+  uint16_t handle = _send_queue.removeByIdx(i);
+  mesh::Packet* packet = _working.alloc();
+  _arena.load(handle, packet);
+  _arena.release(handle);
+  return packet;
+}
+
+void CompactPacketManager::queueInbound(mesh::Packet* packet, uint32_t scheduled_for) {
+  enqueue(_rx_queue, packet, 0, scheduled_for);
+}
+
+mesh::Packet* CompactPacketManager::getNextInbound(uint32_t now) {
+  return dequeue(_rx_queue, now);
+}
+
+int CompactPacketManager::getInboundCount() const {
+  return _rx_queue.count();
+}
+
+mesh::Packet* CompactPacketManager::getInboundByIdx(int i) {
+  if (i >= _rx_queue.count()) return NULL;
+
+  _arena.load(_rx_queue.itemAt(i), &_peek);
+  return &_peek;   // only valid until next call
+}
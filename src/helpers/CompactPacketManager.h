@@ -0,0 +1,95 @@
+#pragma once
+
+#include <helpers/StaticPoolPacketManager.h>
+
+#define PACKET_ARENA_UNIT_SIZE   32     // smallest size class
+#define PACKET_ARENA_NUM_ORDERS   4     // size classes: 32, 64, 128, 256 bytes
+#define PACKET_ARENA_PAGE_SIZE  (PACKET_ARENA_UNIT_SIZE << (PACKET_ARENA_NUM_ORDERS - 1))
+
+/**
+ * \brief  Stores packets in their compact (wire) encoding, in size classed blocks of 32, 64, 128 or 256 bytes,
+ *         carved from fixed 256 byte pages. Blocks are split and re-merged buddy-style, so the pages get shared
+ *         out according to the actual traffic mix. Handles are 1 based (0 = none).
+ */
+class PacketArena {
+  uint8_t* _mem;
+  uint8_t* _unit_info;    // per unit, at start of each block: order, plus BLOCK_FREE flag
+#if MESH_LATENCY_STATS
+  uint32_t* _timestamps;  // per unit, at start of each block: packet's _t_origin, _t_queued
+#endif
+  uint16_t _free_head[PACKET_ARENA_NUM_ORDERS];   // 0xFFFF = none
+  int _num_units;
+  int _num_stored, _bytes_used, _high_water_bytes;
+  uint32_t _n_store_fails;
+
+  uint8_t* unitPtr(int unit) const { return &_mem[unit * PACKET_ARENA_UNIT_SIZE]; }
+  uint16_t& linkPrev(int unit) const { return ((uint16_t *) unitPtr(unit))[0]; }
+  uint16_t& linkNext(int unit) const { return ((uint16_t *) unitPtr(unit))[1]; }
+  void pushFree(int unit, int order);
+  void unlinkFree(int unit, int order);
+  int allocBlock(int order);
+  void freeBlock(int unit);
+
+public:
+  PacketArena(int num_pages);
+
+  /**
+   * \returns  handle to the stored copy of packet, or 0 if no room
+   */
+  uint16_t store(const mesh::Packet* packet);
+
+  /**
+   * \brief  decodes stored packet into 'dest'  (handle remains valid)
+   */
+  void load(uint16_t handle, mesh::Packet* dest) const;
+  void release(uint16_t handle);
+
+  int getNumStored() const { return _num_stored; }
+  int getCapacityBytes() const { return _num_units * PACKET_ARENA_UNIT_SIZE; }
+  int getBytesUsed() const { return _bytes_used; }   // in whole blocks
+  int getHighWaterBytes() const { return _high_water_bytes; }
+  uint32_t getNumStoreFails() const { return _n_store_fails; }
+  void resetStats();
+};
+
+/**
+ * \brief  A PacketManager for RAM constrained boards. Only a small 'working' pool of full Packet instances exists, for
+ *         packets being built, processed, or transmitted. Queued (inbound delayed, or outbound) packets are held
+ *         compactly in a PacketArena, so an ACK takes 32 bytes, a short direct message 64 or 128, rather than the
+ *         full sizeof(mesh::Packet).
+ *         NOTE: once queued, the caller's Packet instance is returned to the working pool.
+ */
+class CompactPacketManager : public mesh::PacketManager {
+  PacketPool _working;
+  PacketArena _arena;
+  ScheduledQueue<uint16_t> _send_queue, _rx_queue;
+  mesh::Packet _peek;    // for getOutboundByIdx(), getInboundByIdx()
+
+  void enqueue(ScheduledQueue<uint16_t>& queue, mesh::Packet* packet, uint8_t priority, uint32_t scheduled_for);
+  mesh::Packet* dequeue(ScheduledQueue<uint16_t>& queue, uint32_t now);
+
+public:
+  /**
+   * \param  arena_pages  number of 256 byte pages for queued packets
+   * \param  num_working  number of full Packet instances, for packets in flight
+   * \param  max_queued   max entries in each of the outbound/inbound queues (default assumes 64 bytes average)
+   */
+  CompactPacketManager(int arena_pages, int num_working, int max_queued=0);
+
+  mesh::Packet* allocNew() override;
+  void free(mesh::Packet* packet) override;
+  void queueOutbound(mesh::Packet* packet, uint8_t priority, uint32_t scheduled_for) override;
+  mesh::Packet* getNextOutbound(uint32_t now) override;
+  int getOutboundCount(uint32_t now) const override;
+  int getFreeCount() const override;
+  mesh::Packet* getOutboundByIdx(int i) override;
+  mesh::Packet* removeOutboundByIdx(int i) override;
+  void queueInbound(mesh::Packet* packet, uint32_t scheduled_for) override;
+  mesh::Packet* getNextInbound(uint32_t now) override;
+  int getInboundCount() const override;
+  mesh::Packet* getInboundByIdx(int i) override;
+
+  const PacketPool& getPool() const { return _working; }
+  const PacketArena& getArena() const { return _arena; }
+  void resetPoolStats() { _working.resetStats(); _arena.resetStats(); }
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "BaseSerialInterface.h"
+
+/**
+ * \brief  Receive side of the framing used over byte streams (serial, TCP): '<', len LSB, len MSB, frame bytes.
+ *         Bytes before a '<' are skipped, and frames longer than MAX_FRAME_SIZE are truncated.
+ *         One per stream, so a stream's partial frame isn't disturbed by others.
+ */
+class FrameParser {
+  enum State : uint8_t { IDLE, HDR_FOUND, LEN1_FOUND, LEN2_FOUND };
+
+  State _state;
+  uint16_t _frame_len;
+  uint16_t _rx_len;
+  uint8_t _buf[MAX_FRAME_SIZE];
+
+public:
+  FrameParser() { reset(); }
+
+  void reset() { _state = IDLE; }
+
+  /**
+   * \returns  max bytes the stream can be read for without going past the end of the current frame, ie. so a
+   *           reader never has to hold on to bytes of the following frame.
+   */
+  size_t wanted() const {
+    if (_state == HDR_FOUND) return 2;
+    if (_state == LEN2_FOUND) return _frame_len - _rx_len;
+    return 1;
+  }
+
+  /**
+   * \returns  length of frame (copied to 'dest') if 'c' completed one, otherwise 0
+   */
+  size_t feed(uint8_t c, uint8_t dest[]) {
+    switch (_state) {
+      case IDLE:
+        if (c == '<') {
+          _state = HDR_FOUND;
+        }
+        break;
+      case HDR_FOUND:
+        _frame_len = c;   // LSB
+        _state = LEN1_FOUND;
+        break;
+      case LEN1_FOUND:
+        _frame_len |= ((uint16_t)c) << 8;   // MSB
+        _rx_len = 0;
+        _state = _frame_len > 0 ? LEN2_FOUND : IDLE;
+        break;
+      default:
+        if (_rx_len < MAX_FRAME_SIZE) {
+          _buf[_rx_len] = c;   // rest of frame will be discarded if > MAX
+        }
+        _rx_len++;
+        if (_rx_len >= _frame_len) {  // received a complete frame?
+          size_t len = _frame_len > MAX_FRAME_SIZE ? MAX_FRAME_SIZE : _frame_len;    // truncate
+          memcpy(dest, _buf, len);
+          _state = IDLE;  // reset state, for next frame
+          return len;
+        }
+    }
+    return 0;
+  }
+};
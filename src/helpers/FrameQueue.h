@@ -0,0 +1,165 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define FRAME_QUEUE_MAX_LEN   255    // (length prefix is one byte)
+
+struct FrameQueueStats {
+  uint16_t depth;         // frames currently queued
+  uint16_t max_depth;     // high-water mark
+  uint16_t bytes_used;    // ring bytes currently in use (incl. length prefixes)
+  uint16_t capacity;      // ring size, in bytes
+  uint32_t num_queued;    // total frames accepted
+  uint32_t num_dropped;   // total frames rejected (queue full, or too big)
+};
+
+/**
+ * \brief  FIFO of variable length frames, packed into a byte ring of SIZE bytes: [len][frame bytes]...
+ *         So a ring sized for a few max-size frames holds many more of the typical small ones.
+ *         A frame is never split across the end of the ring (a zero length marker means 'wrap to start'), so
+ *         peek() can hand out a pointer straight into the ring, for the caller to send from without copying.
+ *         Safe for ONE producer (push) and ONE consumer (peek/pop) in different tasks, eg. a BLE callback
+ *         and the main loop, as each side only moves its own index. clear() is not, though.
+ */
+template <int SIZE>
+class FrameQueue {
+  static_assert(SIZE > FRAME_QUEUE_MAX_LEN && SIZE < 0x10000, "FrameQueue SIZE out of range");
+
+  uint8_t _buf[SIZE];
+  volatile uint16_t _head, _tail;    // next read, next write. Empty when equal
+  volatile uint32_t _num_popped;     // consumer side
+  uint32_t _num_queued, _num_dropped;
+  uint16_t _max_depth;
+
+  /**
+   * \returns  offset of where to put a record of 'len' frame bytes, or -1 if no room
+   */
+  int allocate(size_t len) {
+    int need = 1 + len;
+    int head = _head, tail = _tail;
+    if (tail >= head) {
+      if (need <= SIZE - tail - (head == 0 ? 1 : 0)) return tail;   // (tail must not catch up with head)
+      if (need < head) {
+        _buf[tail] = 0;   // wrap marker
+        return 0;
+      }
+      return -1;
+    }
+    return need < head - tail ? tail : -1;
+  }
+
+  void commit(int pos, size_t len) {
+    int tail = pos + 1 + len;
+    __sync_synchronize();   // frame bytes must land before the new tail does
+    _tail = tail == SIZE ? 0 : tail;   // (publishes the record to consumer)
+    _num_queued++;
+    uint16_t depth = _num_queued - _num_popped;
+    if (depth > _max_depth) _max_depth = depth;
+  }
+
+public:
+  FrameQueue() {
+    _head = _tail = 0;
+    _num_popped = _num_queued = _num_dropped = 0;
+    _max_depth = 0;
+  }
+
+  /**
+   * \brief  discards all queued frames (statistics are kept)
+   */
+  void clear() {
+    _num_popped = _num_queued;
+    _head = _tail = 0;
+  }
+
+  bool push(const uint8_t src[], size_t len) {
+    const uint8_t* parts[1] = { src };
+    return push(parts, &len, 1);
+  }
+
+  /**
+   * \brief  scatter-gather version. Queues ONE frame made from the 'num_parts' pieces, eg. a header and a payload,
+   *         so the caller doesn't need to assemble them into a buffer first.
+   * \returns  false if frame was dropped (no room, or empty/too big)
+   */
+  bool push(const uint8_t* const parts[], const size_t lens[], int num_parts) {
+    size_t len = 0;
+    for (int i = 0; i < num_parts; i++) len += lens[i];
+
+    int pos = (len > 0 && len <= FRAME_QUEUE_MAX_LEN) ? allocate(len) : -1;
+    if (pos < 0) {
+      _num_dropped++;
+      return false;
+    }
+    _buf[pos] = len;
+    uint8_t* dest = &_buf[pos + 1];
+    for (int i = 0; i < num_parts; i++) {
+      memcpy(dest, parts[i], lens[i]);
+      dest += lens[i];
+    }
+    commit(pos, len);
+    return true;
+  }
+
+  /**
+   * \returns  oldest frame, still in the queue (valid until pop()), or NULL if queue is empty
+   */
+  const uint8_t* peek(size_t& len) {
+    int head = _head;
+    if (head == _tail) return NULL;
+    __sync_synchronize();   // (see commit())
+    if (_buf[head] == 0) {   // wrap marker?
+      _head = head = 0;
+      if (head == _tail) return NULL;
+    }
+    len = _buf[head];
+    return &_buf[head + 1];
+  }
+
+  /**
+   * \brief  removes the oldest frame (ie. the one from peek())
+   */
+  void pop() {
+    size_t len;
+    if (peek(len) == NULL) return;
+    int head = _head + 1 + len;
+    __sync_synchronize();
+    _head = head == SIZE ? 0 : head;
+    _num_popped++;
+  }
+
+  /**
+   * \brief  copies out, and removes, the oldest frame
+   * \returns  length of frame, or 0 if queue is empty
+   */
+  size_t pop(uint8_t dest[]) {
+    size_t len;
+    const uint8_t* src = peek(len);
+    if (src == NULL) return 0;
+    memcpy(dest, src, len);
+    pop();
+    return len;
+  }
+
+  bool isEmpty() const { return _head == _tail; }
+  int count() const { return _num_queued - _num_popped; }
+
+  /**
+   * \returns  ring bytes in use, incl. length prefixes (and any gap left at the end by a wrap)
+   */
+  int bytesUsed() const {
+    int head = _head, tail = _tail;
+    return tail >= head ? tail - head : SIZE - head + tail;
+  }
+
+  void getStats(FrameQueueStats& stats) const {
+    stats.depth = count();
+    stats.max_depth = _max_depth;
+    stats.bytes_used = bytesUsed();
+    stats.capacity = SIZE;
+    stats.num_queued = _num_queued;
+    stats.num_dropped = _num_dropped;
+  }
+};
@@ -8,6 +8,9 @@
   #define FILESYSTEM  Adafruit_LittleFS
 
   using namespace Adafruit_LittleFS_Namespace;
+#elif defined(LINUX_PLATFORM)
+  #include <helpers/linux/RAMFileSystem.h>
+  #define FILESYSTEM  RAMFileSystem
 #endif
 #include <Identity.h>
 
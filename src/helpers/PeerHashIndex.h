@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#define PEER_INDEX_NONE   0xFFFF
+
+/**
+ * \brief  Index of a peer table (contacts, clients, channels) by the first byte of pub_key (or channel hash), ie. the
+ *         hash used in packets.
+ *         Each of the 256 buckets is a chain of table indexes, in ascending order, threaded through a 'next'
+ *         array. So a search is O(matches) rather than O(table size), for 512 + 2*CAPACITY bytes.
+ *         NOTE: the owning table must call add()/remove() as entries change, or rebuild() when entries move.
+ */
+template <int CAPACITY>
+class PeerHashIndex {
+  uint16_t _head[256];
+  uint16_t _next[CAPACITY];
+
+public:
+  PeerHashIndex() { clear(); }
+
+  void clear() {
+    for (int i = 0; i < 256; i++) _head[i] = PEER_INDEX_NONE;
+  }
+
+  void add(int idx, uint8_t hash) {
+    uint16_t* link = &_head[hash];
+    while (*link != PEER_INDEX_NONE && *link < idx) link = &_next[*link];   // keep chain in ascending order
+    if (*link == idx) return;   // already in this chain (re-linking it would make a loop)
+    _next[idx] = *link;
+    *link = idx;
+  }
+
+  void remove(int idx, uint8_t hash) {
+    uint16_t* link = &_head[hash];
+    while (*link != PEER_INDEX_NONE && *link != idx) link = &_next[*link];
+    if (*link == idx) *link = _next[idx];
+  }
+
+  /**
+   * \brief  re-index all of 'table', after entries have been moved
+   * \param  get_hash  function/lambda, returning the hash byte of table entry 'i'
+   */
+  template <typename F>
+  void rebuild(int num_entries, F get_hash) {
+    clear();
+    for (int i = num_entries - 1; i >= 0; i--) {   // pushing at head, in reverse, gives ascending chains
+      uint8_t hash = get_hash(i);
+      _next[i] = _head[hash];
+      _head[hash] = i;
+    }
+  }
+
+  /**
+   * \returns  table index of first entry with given hash, or -1 if none
+   */
+  int first(uint8_t hash) const { return _head[hash] == PEER_INDEX_NONE ? -1 : _head[hash]; }
+
+  /**
+   * \returns  table index of next entry with same hash as entry 'idx', or -1 if no more
+   */
+  int next(int idx) const { return _next[idx] == PEER_INDEX_NONE ? -1 : _next[idx]; }
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * \brief  Queue of items, each with a priority (lower is more important) and a 'scheduled for' time. get() returns
+ *         the most important of the entries now due, or earliest added amongst equal priorities.
+ *         Held as two binary heaps, sharing the one table: entries not yet due, ordered by scheduled_for (stored from
+ *         the end of the table, backwards), and entries found to be due, ordered by priority then insertion order.
+ *         So add()/get() are O(log n), and countBefore() is O(1) when nothing is due.
+ *         NOTE: 'now' is expected to not go backwards between calls.
+ *         T must be a small value type (pointer, or handle), where T() means 'no item'.
+ */
+template <typename T>
+class ScheduledQueue {
+  struct Entry {
+    T item;
+    uint32_t scheduled_for;
+    uint32_t seq;       // insertion order
+    uint8_t priority;
+  };
+  Entry* _table;
+  int _size, _num_due, _num_future;
+  uint32_t _next_seq;
+
+  Entry& at(bool future, int i) const { return future ? _table[_size - 1 - i] : _table[i]; }
+
+  bool isBefore(bool future, const Entry& a, const Entry& b) const {
+    if (future) return a.scheduled_for < b.scheduled_for;
+    if (a.priority != b.priority) return a.priority < b.priority;
+    return (int32_t)(a.seq - b.seq) < 0;
+  }
+
+  void siftUp(bool future, int i) {
+    while (i > 0) {
+      int parent = (i - 1) / 2;
+      if (!isBefore(future, at(future, i), at(future, parent))) break;
+      Entry tmp = at(future, i);
+      at(future, i) = at(future, parent);
+      at(future, parent) = tmp;
+      i = parent;
+    }
+  }
+
+  void siftDown(bool future, int i) {
+    int n = future ? _num_future : _num_due;
+    for (;;) {
+      int best = i;
+      int c = i*2 + 1;
+      if (c < n && isBefore(future, at(future, c), at(future, best))) best = c;
+      c++;
+      if (c < n && isBefore(future, at(future, c), at(future, best))) best = c;
+      if (best == i) break;
+
+      Entry tmp = at(future, i);
+      at(future, i) = at(future, best);
+      at(future, best) = tmp;
+      i = best;
+    }
+  }
+
+  void removeAt(bool future, int i) {
+    int& n = future ? _num_future : _num_due;
+    n--;
+    if (i < n) {
+      at(future, i) = at(future, n);   // move last into the hole, then restore heap order
+      siftDown(future, i);
+      siftUp(future, i);
+    }
+  }
+
+  void push(bool future, const Entry& e) {
+    int& n = future ? _num_future : _num_due;
+    at(future, n) = e;
+    n++;
+    siftUp(future, n - 1);
+  }
+
+  int countFutureBefore(int i, uint32_t now) const {
+    if (i >= _num_future || at(true, i).scheduled_for > now) return 0;   // this sub-tree is all in the future
+    return 1 + countFutureBefore(i*2 + 1, now) + countFutureBefore(i*2 + 2, now);
+  }
+
+public:
+  ScheduledQueue(int max_entries) {
+    _table = new Entry[max_entries];
+    _size = max_entries;
+    _num_due = _num_future = 0;
+    _next_seq = 0;
+  }
+
+  int count() const { return _num_due + _num_future; }
+  bool isFull() const { return count() == _size; }
+
+  int countBefore(uint32_t now) const {
+    if (_num_future == 0 || at(true, 0).scheduled_for > now) return _num_due;   // nothing more has become due
+    return _num_due + countFutureBefore(0, now);
+  }
+
+  /**
+   * \returns  false if queue is full
+   */
+  bool add(T item, uint8_t priority, uint32_t scheduled_for) {
+    if (isFull()) return false;
+
+    Entry e;
+    e.item = item;
+    e.priority = priority;
+    e.scheduled_for = scheduled_for;
+    e.seq = _next_seq++;
+    push(true, e);   // becomes due in get()
+    return true;
+  }
+
+  T get(uint32_t now) {
+    while (_num_future > 0 && at(true, 0).scheduled_for <= now) {   // move any newly due entries across
+      Entry e = at(true, 0);
+      removeAt(true, 0);
+      push(false, e);
+    }
+    if (_num_due == 0) return T();   // empty, or all items are still in the future
+
+    T top = at(false, 0).item;
+    removeAt(false, 0);
+    return top;
+  }
+
+  T itemAt(int i) const {
+    if (i < _num_due) return at(false, i).item;
+    return at(true, i - _num_due).item;
+  }
+
+  T removeByIdx(int i) {
+    if (i >= count()) return T();  // invalid index
+
+    T item = itemAt(i);
+    if (i < _num_due) {
+      removeAt(false, i);
+    } else {
+      removeAt(true, i - _num_due);
+    }
+    return item;
+  }
+};
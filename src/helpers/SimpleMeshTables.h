@@ -1,111 +1,360 @@
 #pragma once
 
 #include <Mesh.h>
+#include <helpers/ArduinoHelpers.h>
 
 #ifdef ESP32
   #include <FS.h>
+#elif defined(LINUX_PLATFORM)
+  #include <helpers/linux/RAMFileSystem.h>
 #endif
 
-#define MAX_PACKET_HASHES  128
-#define MAX_PACKET_ACKS     64
+#ifndef MAX_PACKET_HASHES
+  #define MAX_PACKET_HASHES  128
+#endif
+#ifndef MAX_PACKET_ACKS
+  #define MAX_PACKET_ACKS     64
+#endif
+
+#ifndef MESH_TABLES_MIN_RETAIN_MILLIS
+  #define MESH_TABLES_MIN_RETAIN_MILLIS   60000     // entries younger than this are never expired (only displaced when full)
+#endif
+#ifndef MESH_TABLES_EXPIRY_MILLIS
+  #define MESH_TABLES_EXPIRY_MILLIS     3600000     // entries older than this are dropped, and no longer match
+#endif
+
+#define MESH_TABLES_FILE_MAGIC     0x4C42544D   // "MTBL"
+#define MESH_TABLES_FILE_VERSION   2
+
+static constexpr int meshTablesIndexSize(int capacity, int n=16) {
+  return n >= capacity*2 ? n : meshTablesIndexSize(capacity, n*2);
+}
+
+/**
+ * \brief  Fixed capacity set of KEY_SIZE byte keys, with O(1) lookup, and eviction by age.
+ *         Keys are kept in a ring (in insertion order, so also in age order), with an open-addressing (linear probing)
+ *         index over the ring. Each key carries its insertion time, and expires after EXPIRY_MILLIS. Once full, the
+ *         oldest key is displaced, and if that was younger than MIN_RETAIN_MILLIS it is counted as 'evicted early'
+ *         (ie. the set is too small for the traffic rate).
+ *         Keys are expected to be well distributed already (ie. packet hashes, CRCs)
+ */
+template <int KEY_SIZE, int CAPACITY>
+class FIFOKeySet {
+  static_assert(CAPACITY > 0 && CAPACITY < 0xFFFF, "capacity must fit in uint16_t index");
+
+  static const int INDEX_SIZE = meshTablesIndexSize(CAPACITY);   // power of 2, at most 50% load
+  static const uint32_t INDEX_MASK = INDEX_SIZE - 1;
+
+  uint8_t  _keys[CAPACITY*KEY_SIZE];
+  uint32_t _times[CAPACITY];     // insertion time (millis) of each ring position
+  uint16_t _index[INDEX_SIZE];   // 0 = empty slot, otherwise ring position + 1
+  int _next;    // next ring position to write (ie. oldest, once full)
+  int _count;
+  uint32_t _n_expired, _n_evicted, _n_evicted_early;
+  uint32_t _min_evicted_age;
+
+  const uint8_t* keyAt(int pos) const { return &_keys[pos*KEY_SIZE]; }
+
+  static uint32_t homeSlot(const uint8_t* key) {
+    uint32_t h;
+    memcpy(&h, key, 4);
+    return (h ^ (h >> 16)) & INDEX_MASK;
+  }
+
+  int findSlot(const uint8_t* key) const {
+    for (uint32_t s = homeSlot(key); _index[s]; s = (s + 1) & INDEX_MASK) {
+      if (memcmp(keyAt(_index[s] - 1), key, KEY_SIZE) == 0) return s;
+    }
+    return -1;
+  }
+
+  void removeSlot(uint32_t s) {   // backward-shift deletion, so no tombstones needed
+    _index[s] = 0;
+    for (uint32_t j = (s + 1) & INDEX_MASK; _index[j]; j = (j + 1) & INDEX_MASK) {
+      uint32_t home = homeSlot(keyAt(_index[j] - 1));
+      if (((j - home) & INDEX_MASK) >= ((j - s) & INDEX_MASK)) {   // can move back into the hole
+        _index[s] = _index[j];
+        _index[j] = 0;
+        s = j;
+      }
+    }
+  }
+
+  int liveSlot(int pos) const {   // -1 if entry was removed by remove(), or expired
+    int s = findSlot(keyAt(pos));
+    return s >= 0 && _index[s] == pos + 1 ? s : -1;
+  }
+
+  bool isLive(int pos) const { return liveSlot(pos) >= 0; }
+
+  static bool isExpired(uint32_t age) { return age >= EXPIRY_MILLIS && age >= MIN_RETAIN_MILLIS; }
+
+public:
+  static const uint32_t MIN_RETAIN_MILLIS = MESH_TABLES_MIN_RETAIN_MILLIS;
+  static const uint32_t EXPIRY_MILLIS = MESH_TABLES_EXPIRY_MILLIS;
+
+  FIFOKeySet() { reset(); resetStats(); }
+
+  void reset() {
+    memset(_keys, 0, sizeof(_keys));
+    memset(_times, 0, sizeof(_times));
+    memset(_index, 0, sizeof(_index));
+    _next = _count = 0;
+  }
+
+  void resetStats() {
+    _n_expired = _n_evicted = _n_evicted_early = 0;
+    _min_evicted_age = 0xFFFFFFFF;
+  }
+
+  int getCapacity() const { return CAPACITY; }
+  int getCount() const { return _count; }
+
+  /**
+   * \returns  true if key is present and not expired. (an expired key is removed)
+   */
+  bool contains(const uint8_t* key, uint32_t now) {
+    int s = findSlot(key);
+    if (s < 0) return false;
+    if (isExpired(now - _times[_index[s] - 1])) {
+      removeSlot(s);
+      _n_expired++;
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * \brief  adds the key (caller must check it is NOT already present), displacing the oldest if full
+   */
+  void insert(const uint8_t* key, uint32_t now) {
+    if (_count == CAPACITY) {
+      int s = liveSlot(_next);
+      if (s >= 0) {
+        removeSlot(s);
+        uint32_t age = now - _times[_next];
+        if (isExpired(age)) {
+          _n_expired++;
+        } else {
+          _n_evicted++;
+          if (age < MIN_RETAIN_MILLIS) _n_evicted_early++;
+          if (age < _min_evicted_age) _min_evicted_age = age;
+        }
+      }
+    } else {
+      _count++;
+    }
+    memcpy(&_keys[_next*KEY_SIZE], key, KEY_SIZE);
+    _times[_next] = now;
+
+    uint32_t s = homeSlot(key);
+    while (_index[s]) s = (s + 1) & INDEX_MASK;
+    _index[s] = _next + 1;
+
+    _next = (_next + 1) % CAPACITY;
+  }
+
+  bool remove(const uint8_t* key) {
+    int s = findSlot(key);
+    if (s < 0) return false;
+    removeSlot(s);
+    return true;
+  }
+
+  /**
+   * \brief  visits the live keys, oldest first
+   */
+  template <typename F>
+  void forEach(F fn) const {
+    int start = _count < CAPACITY ? 0 : _next;
+    for (int i = 0; i < _count; i++) {
+      int pos = (start + i) % CAPACITY;
+      if (isLive(pos)) fn(keyAt(pos));
+    }
+  }
+
+  int getLiveCount() const {
+    int n = 0;
+    forEach([&n](const uint8_t* key) { n++; });
+    return n;
+  }
+
+  uint32_t getNumExpired() const { return _n_expired; }
+  uint32_t getNumEvicted() const { return _n_evicted; }   // displaced by a newer key, before expiry
+  uint32_t getNumEvictedEarly() const { return _n_evicted_early; }   // .. and within the min retention window
+
+  /**
+   * \returns  youngest age (millis) of any key displaced before expiry, or 0xFFFFFFFF if none
+   */
+  uint32_t getMinEvictedAge() const { return _min_evicted_age; }
+};
 
 class SimpleMeshTables : public mesh::MeshTables {
-  uint8_t _hashes[MAX_PACKET_HASHES*MAX_HASH_SIZE];
-  int _next_idx;
-  uint32_t _acks[MAX_PACKET_ACKS];
-  int _next_ack_idx;
+  FIFOKeySet<MAX_HASH_SIZE, MAX_PACKET_HASHES> _hashes;
+  FIFOKeySet<4, MAX_PACKET_ACKS> _acks;
+  mesh::MillisecondClock* _ms;
   uint32_t _direct_dups, _flood_dups;
 
+  static mesh::MillisecondClock* defaultClock() {
+    static ArduinoMillis ms;
+    return &ms;
+  }
+
+#if defined(ESP32) || defined(LINUX_PLATFORM)
+  template <int KEY_SIZE, int CAPACITY>
+  static void writeKeys(File& f, const FIFOKeySet<KEY_SIZE, CAPACITY>& keys) {
+    uint8_t key_size = KEY_SIZE;
+    uint16_t count = keys.getLiveCount();
+    f.write(&key_size, 1);
+    f.write((const uint8_t *) &count, sizeof(count));
+    keys.forEach([&f](const uint8_t* key) { f.write(key, KEY_SIZE); });
+  }
+
+  template <int KEY_SIZE, int CAPACITY>
+  static bool readKeys(File& f, FIFOKeySet<KEY_SIZE, CAPACITY>& keys, uint32_t now) {
+    uint8_t key_size;
+    uint16_t count;
+    if (f.read(&key_size, 1) != 1 || key_size != KEY_SIZE) return false;
+    if (f.read((uint8_t *) &count, sizeof(count)) != sizeof(count)) return false;
+
+    uint8_t key[KEY_SIZE];
+    for (int i = 0; i < count; i++) {   // oldest first, so if capacity has shrunk the newest are retained
+      if (f.read(key, KEY_SIZE) != KEY_SIZE) return false;
+      if (!keys.contains(key, now)) keys.insert(key, now);   // restored keys start a new retention window
+    }
+    return true;
+  }
+
+  void restoreLegacy(File& f, uint32_t now) {   // version 1: raw cyclic tables of 128 hashes and 64 acks
+    uint8_t hashes[128*MAX_HASH_SIZE];
+    uint32_t acks[64];
+    int next_idx = 0, next_ack_idx = 0;
+    memset(hashes, 0, sizeof(hashes));
+    memset(acks, 0, sizeof(acks));
+    if (f.read(hashes, sizeof(hashes)) != sizeof(hashes)
+      || f.read((uint8_t *) &next_idx, sizeof(next_idx)) != sizeof(next_idx)) {
+      MESH_DEBUG_PRINTLN("SimpleMeshTables::restoreFrom(): truncated file");
+      return;
+    }
+    bool has_acks = f.read((uint8_t *) &acks[0], sizeof(acks)) == sizeof(acks)
+      && f.read((uint8_t *) &next_ack_idx, sizeof(next_ack_idx)) == sizeof(next_ack_idx);
+    next_idx = ((next_idx % 128) + 128) % 128;   // (file may be corrupt)
+    next_ack_idx = ((next_ack_idx % 64) + 64) % 64;
+
+    static const uint8_t zeroes[MAX_HASH_SIZE] = { 0 };
+    for (int i = 0; i < 128; i++) {
+      const uint8_t* key = &hashes[((next_idx + i) % 128)*MAX_HASH_SIZE];
+      if (memcmp(key, zeroes, MAX_HASH_SIZE) != 0 && !_hashes.contains(key, now)) _hashes.insert(key, now);
+    }
+    for (int i = 0; has_acks && i < 64; i++) {
+      const uint8_t* key = (const uint8_t *) &acks[(next_ack_idx + i) % 64];
+      if (acks[(next_ack_idx + i) % 64] != 0 && !_acks.contains(key, now)) _acks.insert(key, now);
+    }
+  }
+#endif
+
 public:
-  SimpleMeshTables() { 
-    memset(_hashes, 0, sizeof(_hashes));
-    _next_idx = 0;
-    memset(_acks, 0, sizeof(_acks));
-    _next_ack_idx = 0;
+  /**
+   * \param  ms  clock for entry ages, or NULL for millis()
+   */
+  SimpleMeshTables(mesh::MillisecondClock* ms=NULL) {
+    _ms = ms ? ms : defaultClock();
     _direct_dups = _flood_dups = 0;
   }
 
-#ifdef ESP32
+#if defined(ESP32) || defined(LINUX_PLATFORM)
   void restoreFrom(File f) {
-    f.read(_hashes, sizeof(_hashes));
-    f.read((uint8_t *) &_next_idx, sizeof(_next_idx));
-    f.read((uint8_t *) &_acks[0], sizeof(_acks));
-    f.read((uint8_t *) &_next_ack_idx, sizeof(_next_ack_idx));
+    _hashes.reset();
+    _acks.reset();
+
+    uint32_t now = _ms->getMillis();
+    uint32_t magic = 0;
+    uint8_t version = 0;
+    f.read((uint8_t *) &magic, sizeof(magic));
+    if (magic != MESH_TABLES_FILE_MAGIC) {
+      f.seek(0);
+      restoreLegacy(f, now);
+    } else if (f.read(&version, 1) == 1 && version == MESH_TABLES_FILE_VERSION) {
+      if (!readKeys(f, _hashes, now) || !readKeys(f, _acks, now)) {
+        MESH_DEBUG_PRINTLN("SimpleMeshTables::restoreFrom(): truncated file");
+      }
+    } else {
+      MESH_DEBUG_PRINTLN("SimpleMeshTables::restoreFrom(): unsupported version: %d", (uint32_t) version);
+    }
   }
   void saveTo(File f) {
-    f.write(_hashes, sizeof(_hashes));
-    f.write((const uint8_t *) &_next_idx, sizeof(_next_idx));
-    f.write((const uint8_t *) &_acks[0], sizeof(_acks));
-    f.write((const uint8_t *) &_next_ack_idx, sizeof(_next_ack_idx));
+    uint32_t magic = MESH_TABLES_FILE_MAGIC;
+    uint8_t version = MESH_TABLES_FILE_VERSION;
+    f.write((const uint8_t *) &magic, sizeof(magic));
+    f.write(&version, 1);
+    writeKeys(f, _hashes);
+    writeKeys(f, _acks);
   }
 #endif
 
   bool hasSeen(const mesh::Packet* packet) override {
+    uint32_t now = _ms->getMillis();
     if (packet->getPayloadType() == PAYLOAD_TYPE_ACK) {
-      uint32_t ack;
-      memcpy(&ack, packet->payload, 4);
-      for (int i = 0; i < MAX_PACKET_ACKS; i++) {
-        if (ack == _acks[i]) { 
-          if (packet->isRouteDirect()) {
-            _direct_dups++;   // keep some stats
-          } else {
-            _flood_dups++;
-          }
-          return true;
+      const uint8_t* ack = packet->payload;   // the 4 byte CRC
+      if (_acks.contains(ack, now)) {
+        if (packet->isRouteDirect()) {
+          _direct_dups++;   // keep some stats
+        } else {
+          _flood_dups++;
         }
+        return true;
       }
-  
-      _acks[_next_ack_idx] = ack;
-      _next_ack_idx = (_next_ack_idx + 1) % MAX_PACKET_ACKS;  // cyclic table  
+
+      _acks.insert(ack, now);
       return false;
     }
 
     uint8_t hash[MAX_HASH_SIZE];
     packet->calculatePacketHash(hash);
 
-    const uint8_t* sp = _hashes;
-    for (int i = 0; i < MAX_PACKET_HASHES; i++, sp += MAX_HASH_SIZE) {
-      if (memcmp(hash, sp, MAX_HASH_SIZE) == 0) { 
-        if (packet->isRouteDirect()) {
-          _direct_dups++;   // keep some stats
-        } else {
-          _flood_dups++;
-        }
-        return true;
+    if (_hashes.contains(hash, now)) {
+      if (packet->isRouteDirect()) {
+        _direct_dups++;   // keep some stats
+      } else {
+        _flood_dups++;
       }
+      return true;
     }
 
-    memcpy(&_hashes[_next_idx*MAX_HASH_SIZE], hash, MAX_HASH_SIZE);
-    _next_idx = (_next_idx + 1) % MAX_PACKET_HASHES;  // cyclic table
+    _hashes.insert(hash, now);
     return false;
   }
 
   void clear(const mesh::Packet* packet) override {
     if (packet->getPayloadType() == PAYLOAD_TYPE_ACK) {
-      uint32_t ack;
-      memcpy(&ack, packet->payload, 4);
-      for (int i = 0; i < MAX_PACKET_ACKS; i++) {
-        if (ack == _acks[i]) { 
-          _acks[i] = 0;
-          break;
-        }
-      }
+      _acks.remove(packet->payload);
     } else {
       uint8_t hash[MAX_HASH_SIZE];
       packet->calculatePacketHash(hash);
-
-      uint8_t* sp = _hashes;
-      for (int i = 0; i < MAX_PACKET_HASHES; i++, sp += MAX_HASH_SIZE) {
-        if (memcmp(hash, sp, MAX_HASH_SIZE) == 0) { 
-          memset(sp, 0, MAX_HASH_SIZE);
-          break;
-        }
-      }
+      _hashes.remove(hash);
     }
   }
 
   uint32_t getNumDirectDups() const { return _direct_dups; }
   uint32_t getNumFloodDups() const { return _flood_dups; }
 
-  void resetStats() { _direct_dups = _flood_dups = 0; }
+  uint32_t getNumExpired() const { return _hashes.getNumExpired() + _acks.getNumExpired(); }
+
+  /**
+   * \returns  number of entries displaced (by table being full) while still within MESH_TABLES_MIN_RETAIN_MILLIS.
+   *           If this is non-zero, MAX_PACKET_HASHES/MAX_PACKET_ACKS are too small for the traffic rate.
+   */
+  uint32_t getNumEvictedEarly() const { return _hashes.getNumEvictedEarly() + _acks.getNumEvictedEarly(); }
+
+  /**
+   * \returns  youngest age (millis) of any entry displaced before expiry, or 0xFFFFFFFF if none. Packets re-heard
+   *           after this long may be treated as new.
+   */
+  uint32_t getMinEvictedAge() const { return min(_hashes.getMinEvictedAge(), _acks.getMinEvictedAge()); }
+
+  void resetStats() {
+    _direct_dups = _flood_dups = 0;
+    _hashes.resetStats();
+    _acks.resetStats();
+  }
 };
@@ -1,84 +1,83 @@
 #include "StaticPoolPacketManager.h"
 
-PacketQueue::PacketQueue(int max_entries) {
-  _table = new mesh::Packet*[max_entries];
-  _pri_table = new uint8_t[max_entries];
-  _schedule_table = new uint32_t[max_entries];
-  _size = max_entries;
-  _num = 0;
-}
-
-int PacketQueue::countBefore(uint32_t now) const {
-  int n = 0;
-  for (int j = 0; j < _num; j++) {
-    if (_schedule_table[j] > now) continue;   // scheduled for future... ignore for now
-    n++;
+#define POOL_POISON_BYTE   0xA5
+
+PacketPool::PacketPool(int size) {
+  _packets = new mesh::Packet[size];
+  _free_stack = new mesh::Packet*[size];
+  _size = size;
+  for (int i = 0; i < size; i++) {
+  #if PACKET_POOL_POISON
+    memset(&_packets[i], POOL_POISON_BYTE, sizeof(mesh::Packet));
+  #endif
+    _free_stack[i] = &_packets[size - 1 - i];   // so first alloc() returns _packets[0]
   }
-  return n;
-}
-
-mesh::Packet* PacketQueue::get(uint32_t now) {
-  uint8_t min_pri = 0xFF;
-  int best_idx = -1;
-  for (int j = 0; j < _num; j++) {
-    if (_schedule_table[j] > now) continue;   // scheduled for future... ignore for now
-    if (_pri_table[j] < min_pri) {  // select most important priority amongst non-future entries
-      min_pri = _pri_table[j];
-      best_idx = j;
-    }
+  _num_free = size;
+#if PACKET_POOL_POISON
+  _n_poison_errors = 0;
+#endif
+  resetStats();
+}
+
+#if PACKET_POOL_POISON
+bool PacketPool::isPoisoned(const mesh::Packet* packet) {
+  const uint8_t* bp = (const uint8_t *) packet;
+  for (int i = 0; i < sizeof(mesh::Packet); i++) {
+    if (bp[i] != POOL_POISON_BYTE) return false;
   }
-  if (best_idx < 0) return NULL;   // empty, or all items are still in the future
-
-  mesh::Packet* top = _table[best_idx];
-  int i = best_idx;
-  _num--;
-  while (i < _num) {
-    _table[i] = _table[i+1];
-    _pri_table[i] = _pri_table[i+1];
-    _schedule_table[i] = _schedule_table[i+1];
-    i++;
-  }
-  return top;
+  return true;
 }
+#endif
 
-mesh::Packet* PacketQueue::removeByIdx(int i) {
-  if (i >= _num) return NULL;  // invalid index
+void PacketPool::resetStats() {
+  _high_water = _size - _num_free;
+  _n_alloc_fails = 0;
+}
 
-  mesh::Packet* item = _table[i];
-  _num--;
-  while (i < _num) {
-    _table[i] = _table[i+1];
-    _pri_table[i] = _pri_table[i+1];
-    _schedule_table[i] = _schedule_table[i+1];
-    i++;
+mesh::Packet* PacketPool::alloc() {
+  if (_num_free == 0) {
+    _n_alloc_fails++;
+    return NULL;
   }
-  return item;
+  mesh::Packet* packet = _free_stack[--_num_free];
+  int in_use = _size - _num_free;
+  if (in_use > _high_water) _high_water = in_use;
+
+#if PACKET_POOL_POISON
+  if (!isPoisoned(packet)) {
+    _n_poison_errors++;
+    MESH_DEBUG_PRINTLN("PacketPool::alloc(): ERROR: packet %d was written to after free()", (int)(packet - _packets));
+  }
+  *packet = mesh::Packet();
+#endif
+  return packet;
 }
 
-void PacketQueue::add(mesh::Packet* packet, uint8_t priority, uint32_t scheduled_for) {
-  if (_num == _size) {
-    // TODO: log "FATAL: queue is full!"
+void PacketPool::free(mesh::Packet* packet) {
+  if (!owns(packet) || _num_free == _size) {
+    MESH_DEBUG_PRINTLN("PacketPool::free(): ERROR: packet not from this pool, or pool already full");
+    return;
+  }
+#if PACKET_POOL_POISON
+  if (isPoisoned(packet)) {
+    _n_poison_errors++;
+    MESH_DEBUG_PRINTLN("PacketPool::free(): ERROR: packet %d freed twice", (int)(packet - _packets));
     return;
   }
-  _table[_num] = packet;
-  _pri_table[_num] = priority;
-  _schedule_table[_num] = scheduled_for;
-  _num++;
+  memset(packet, POOL_POISON_BYTE, sizeof(mesh::Packet));
+#endif
+  _free_stack[_num_free++] = packet;
 }
 
 StaticPoolPacketManager::StaticPoolPacketManager(int pool_size): unused(pool_size), send_queue(pool_size), rx_queue(pool_size) {
-  // load up our unusued Packet pool
-  for (int i = 0; i < pool_size; i++) {
-    unused.add(new mesh::Packet(), 0, 0);
-  }
 }
 
 mesh::Packet* StaticPoolPacketManager::allocNew() {
-  return unused.removeByIdx(0);  // just get first one (returns NULL if empty)
+  return unused.alloc();  // returns NULL if empty
 }
 
 void StaticPoolPacketManager::free(mesh::Packet* packet) {
-  unused.add(packet, 0, 0);
+  unused.free(packet);
 }
 
 void StaticPoolPacketManager::queueOutbound(mesh::Packet* packet, uint8_t priority, uint32_t scheduled_for) {
@@ -95,7 +94,7 @@ int  StaticPoolPacketManager::getOutboundCount(uint32_t now) const {
 }
 
 int StaticPoolPacketManager::getFreeCount() const {
-  return unused.count();
+  return unused.getFreeCount();
 }
 
 mesh::Packet* StaticPoolPacketManager::getOutboundByIdx(int i) {
@@ -111,3 +110,10 @@ void StaticPoolPacketManager::queueInbound(mesh::Packet* packet, uint32_t schedu
 mesh::Packet* StaticPoolPacketManager::getNextInbound(uint32_t now) {
   return rx_queue.get(now);
 }
+int StaticPoolPacketManager::getInboundCount() const {
+  return rx_queue.count();
+}
+mesh::Packet* StaticPoolPacketManager::getInboundByIdx(int i) {
+  if (i >= rx_queue.count()) return NULL;
+  return rx_queue.itemAt(i);
+}
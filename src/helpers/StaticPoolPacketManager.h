@@ -1,25 +1,52 @@
 #pragma once
 
 #include <Dispatcher.h>
+#include <helpers/ScheduledQueue.h>
 
-class PacketQueue {
-  mesh::Packet** _table;
-  uint8_t* _pri_table;
-  uint32_t* _schedule_table;
-  int _size, _num;
+#ifndef PACKET_POOL_POISON
+  #define PACKET_POOL_POISON  MESH_DEBUG   // fill released packets with a pattern, and check it on allocation
+#endif
+
+typedef ScheduledQueue<mesh::Packet*> PacketQueue;
+
+/**
+ * \brief  Fixed set of Packet instances (allocated once, contiguously), with the free ones held on a stack, so
+ *         alloc()/free() are O(1).
+ */
+class PacketPool {
+  mesh::Packet* _packets;
+  mesh::Packet** _free_stack;
+  int _size, _num_free;
+  int _high_water;         // max in use at once
+  uint32_t _n_alloc_fails;
+#if PACKET_POOL_POISON
+  uint32_t _n_poison_errors;
+  static bool isPoisoned(const mesh::Packet* packet);
+#endif
 
 public:
-  PacketQueue(int max_entries);
-  mesh::Packet* get(uint32_t now);
-  void add(mesh::Packet* packet, uint8_t priority, uint32_t scheduled_for);
-  int count() const { return _num; }
-  int countBefore(uint32_t now) const;
-  mesh::Packet* itemAt(int i) const { return _table[i]; }
-  mesh::Packet* removeByIdx(int i);
+  PacketPool(int size);
+
+  mesh::Packet* alloc();
+  void free(mesh::Packet* packet);
+  bool owns(const mesh::Packet* packet) const { return packet >= _packets && packet < &_packets[_size]; }
+
+  int getSize() const { return _size; }
+  int getFreeCount() const { return _num_free; }
+  int getHighWaterMark() const { return _high_water; }
+  uint32_t getNumAllocFails() const { return _n_alloc_fails; }
+#if PACKET_POOL_POISON
+  /**
+   * \returns  number of use-after-free (or double free) detections
+   */
+  uint32_t getNumPoisonErrors() const { return _n_poison_errors; }
+#endif
+  void resetStats();
 };
 
 class StaticPoolPacketManager : public mesh::PacketManager {
-  PacketQueue unused, send_queue, rx_queue;
+  PacketPool unused;
+  PacketQueue send_queue, rx_queue;
 
 public:
   StaticPoolPacketManager(int pool_size);
@@ -34,4 +61,9 @@ public:
   mesh::Packet* removeOutboundByIdx(int i) override;
   void queueInbound(mesh::Packet* packet, uint32_t scheduled_for) override;
   mesh::Packet* getNextInbound(uint32_t now) override;
+  int getInboundCount() const override;
+  mesh::Packet* getInboundByIdx(int i) override;
+
+  const PacketPool& getPool() const { return unused; }
+  void resetPoolStats() { unused.resetStats(); }
 };
\ No newline at end of file
@@ -29,6 +29,9 @@ bool BridgeBase::validateChecksum(const uint8_t *data, size_t len, uint16_t rece
 
 void BridgeBase::handleReceivedPacket(mesh::Packet *packet) {
   if (!_seen_packets.hasSeen(packet)) {
+#if MESH_LATENCY_STATS
+    packet->_t_origin = packet->_t_queued = millis();
+#endif
     _mgr->queueInbound(packet, millis() + BRIDGE_DELAY);
   } else {
     _mgr->free(packet);
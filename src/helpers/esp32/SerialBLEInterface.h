@@ -18,18 +18,10 @@ class SerialBLEInterface : public BaseSerialInterface, BLESecurityCallbacks, BLE
   unsigned long _last_write;
   unsigned long adv_restart_time;
 
-  struct Frame {
-    uint8_t len;
-    uint8_t buf[MAX_FRAME_SIZE];
-  };
+  FrameQueue<SERIAL_RECV_QUEUE_BYTES> recv_queue;   // filled by onWrite(), in the BLE task
+  FrameQueue<SERIAL_SEND_QUEUE_BYTES> send_queue;
 
-  #define FRAME_QUEUE_SIZE  4
-  int recv_queue_len;
-  Frame recv_queue[FRAME_QUEUE_SIZE];
-  int send_queue_len;
-  Frame send_queue[FRAME_QUEUE_SIZE];
-
-  void clearBuffers() { recv_queue_len = 0; send_queue_len = 0; }
+  void clearBuffers() { recv_queue.clear(); send_queue.clear(); }
 
 protected:
   // BLESecurityCallbacks methods
@@ -58,7 +50,6 @@ public:
     _isEnabled = false;
     _last_write = 0;
     last_conn_id = 0;
-    send_queue_len = recv_queue_len = 0;
   }
 
   void begin(const char* device_name, uint32_t pin_code);
@@ -72,7 +63,9 @@ public:
 
   bool isWriteBusy() const override;
   size_t writeFrame(const uint8_t src[], size_t len) override;
+  size_t writeFrameParts(const uint8_t* const parts[], const size_t lens[], int num_parts) override;
   size_t checkRecvFrame(uint8_t dest[]) override;
+  bool getSendQueueStats(FrameQueueStats& stats) const override { send_queue.getStats(stats); return true; }
 };
 
 #if BLE_DEBUG_LOGGING && ARDUINO
@@ -6,99 +6,35 @@ void SerialWifiInterface::begin(int port) {
   server.begin(port);
 }
 
-// ---------- public methods
-void SerialWifiInterface::enable() { 
-  if (_isEnabled) return;
+// ---------- BaseTCPSerialInterface methods
 
-  _isEnabled = true;
-  clearBuffers();
-}
-
-void SerialWifiInterface::disable() {
-  _isEnabled = false;
-}
-
-size_t SerialWifiInterface::writeFrame(const uint8_t src[], size_t len) {
-  if (len > MAX_FRAME_SIZE) {
-    WIFI_DEBUG_PRINTLN("writeFrame(), frame too big, len=%d\n", len);
-    return 0;
-  }
-
-  if (deviceConnected && len > 0) {
-    if (send_queue_len >= FRAME_QUEUE_SIZE) {
-      WIFI_DEBUG_PRINTLN("writeFrame(), send_queue is full!");
-      return 0;
-    }
-
-    send_queue[send_queue_len].len = len;  // add to send queue
-    memcpy(send_queue[send_queue_len].buf, src, len);
-    send_queue_len++;
-
-    return len;
-  }
-  return 0;
-}
-
-bool SerialWifiInterface::isWriteBusy() const {
-  return false;
-}
-
-size_t SerialWifiInterface::checkRecvFrame(uint8_t dest[]) {
-  // check if new client connected
+bool SerialWifiInterface::acceptClient(int idx) {
   auto newClient = server.available();
-  if (newClient) {
+  if (!newClient) return false;
 
-    // disconnect existing client
-    deviceConnected = false;
-    client.stop();
-
-    // switch active connection to new client
-    client = newClient;
-    
+  if (idx < 0) {
+    newClient.stop();   // no free slots
+    return false;
   }
+  clients[idx] = newClient;
+  return true;
+}
 
-  if (client.connected()) {
-    if (!deviceConnected) {
-      WIFI_DEBUG_PRINTLN("Got connection");
-      deviceConnected = true;
-    }
-  } else {
-    if (deviceConnected) {
-      deviceConnected = false;
-      WIFI_DEBUG_PRINTLN("Disconnected");
-    }
-  }
+int SerialWifiInterface::readClient(int idx, uint8_t* dest, size_t max_len) {
+  WiFiClient& client = clients[idx];
+  int len = client.available();
+  if (len <= 0) return client.connected() ? 0 : -1;
 
-  if (deviceConnected) {
-    if (send_queue_len > 0) {   // first, check send queue
-      
-      _last_write = millis();
-      int len = send_queue[0].len;
+  return client.read(dest, (size_t)len < max_len ? len : max_len);
+}
 
-      uint8_t pkt[3+len]; // use same header as serial interface so client can delimit frames
-      pkt[0] = '>';
-      pkt[1] = (len & 0xFF);  // LSB
-      pkt[2] = (len >> 8);    // MSB
-      memcpy(&pkt[3], send_queue[0].buf, send_queue[0].len);
-      client.write(pkt, 3 + len);
-      send_queue_len--;
-      for (int i = 0; i < send_queue_len; i++) {   // delete top item from queue
-        send_queue[i] = send_queue[i + 1];
-      }
-    } else {
-      int len = client.available();
-      if (len > 0) {
-        uint8_t buf[MAX_FRAME_SIZE + 4];
-        client.readBytes(buf, len);
-        memcpy(dest, buf+3, len-3); // remove header (don't even check ... problems are on the other dir)
-        return len-3;
-      }
-    }
-  }
+int SerialWifiInterface::writeClient(int idx, const uint8_t* src, size_t len) {
+  WiFiClient& client = clients[idx];
+  if (!client.connected()) return -1;
 
-  return 0;
+  return client.write(src, len);
 }
 
-bool SerialWifiInterface::isConnected() const {
-  return deviceConnected;  //pServer != NULL && pServer->getConnectedCount() > 0;
-}
\ No newline at end of file
+void SerialWifiInterface::closeClient(int idx) {
+  clients[idx].stop();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <MeshCore.h>
+#include <Arduino.h>
+#include <stdlib.h>
+
+/**
+ * \brief  A 'board' for running on a Linux host, ie. mains powered, with no GPIO.
+ */
+class LinuxBoard : public mesh::MainBoard {
+public:
+  void begin() { }
+
+  uint16_t getBattMilliVolts() override { return 4200; }   // always 'fully charged'
+
+  const char* getManufacturerName() const override {
+    return "Linux Host";
+  }
+
+  void reboot() override {
+    Serial.flush();
+    exit(0);
+  }
+
+  void powerOff() override {
+    reboot();
+  }
+
+  uint8_t getStartupReason() const override { return BD_STARTUP_NORMAL; }
+};
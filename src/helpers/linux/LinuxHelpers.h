@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Dispatcher.h>
+#include <time.h>
+#include <sys/random.h>
+
+/**
+ * \brief  Millisecond clock from the host's monotonic clock.
+ */
+class LinuxMillis : public mesh::MillisecondClock {
+public:
+  unsigned long getMillis() override {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+  }
+};
+
+/**
+ * \brief  RTC from the host's wall clock. setCurrentTime() just applies an offset, as we don't
+ *         want to (and normally can't) change the system time.
+ */
+class LinuxRTCClock : public mesh::RTCClock {
+  long offset;
+public:
+  LinuxRTCClock() { offset = 0; }
+  uint32_t getCurrentTime() override { return time(NULL) + offset; }
+  void setCurrentTime(uint32_t t) override { offset = (long)t - (long)time(NULL); }
+};
+
+/**
+ * \brief  RNG from the kernel's entropy pool (suitable for key generation)
+ */
+class LinuxRNG : public mesh::RNG {
+public:
+  void random(uint8_t* dest, size_t sz) override {
+    while (sz > 0) {
+      ssize_t n = getrandom(dest, sz, 0);
+      if (n <= 0) continue;   // interrupted, try again
+      dest += n; sz -= n;
+    }
+  }
+};
@@ -0,0 +1,159 @@
+#include "RAMFileSystem.h"
+
+RAMFileSystem RAMFS;
+
+struct File::Handle {
+  std::string path;
+  std::shared_ptr<std::vector<uint8_t> > data;   // NULL if directory
+  size_t pos;
+  bool writable;
+  bool open;
+  std::vector<std::string> children;   // for directories, the entries for openNextFile()
+  size_t next_child;
+  RAMFileSystem* fs;
+};
+
+static std::string normalise(const char* path) {
+  std::string p = path;
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  while (p.size() > 1 && p[p.size() - 1] == '/') p.erase(p.size() - 1);
+  return p;
+}
+
+File::operator bool() const {
+  return _h && _h->open;
+}
+
+const char* File::name() const {
+  if (!_h) return "";
+  size_t i = _h->path.rfind('/');
+  return _h->path.c_str() + i + 1;
+}
+
+bool File::isDirectory() const {
+  return _h && !_h->data;
+}
+
+size_t File::size() const {
+  return (_h && _h->data) ? _h->data->size() : 0;
+}
+
+size_t File::position() const {
+  return _h ? _h->pos : 0;
+}
+
+bool File::seek(uint32_t pos) {
+  if (!*this || !_h->data || pos > _h->data->size()) return false;
+  _h->pos = pos;
+  return true;
+}
+
+File File::openNextFile() {
+  if (!*this || _h->data || _h->next_child >= _h->children.size()) return File();
+
+  std::string child = _h->path == "/" ? "/" + _h->children[_h->next_child++] : _h->path + "/" + _h->children[_h->next_child++];
+  return _h->fs->open(child.c_str(), FILE_O_READ);
+}
+
+void File::close() {
+  if (_h) _h->open = false;
+}
+
+int File::available() {
+  if (!*this || !_h->data) return 0;
+  return _h->data->size() - _h->pos;
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+  if (available() <= 0) return -1;
+  return (*_h->data)[_h->pos];
+}
+
+int File::read(uint8_t* buf, size_t size) {
+  if (!*this || !_h->data) return -1;
+
+  size_t n = _h->data->size() - _h->pos;
+  if (n > size) n = size;
+  memcpy(buf, _h->data->data() + _h->pos, n);
+  _h->pos += n;
+  return n;
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!*this || !_h->data || !_h->writable) return 0;
+
+  std::vector<uint8_t>& d = *_h->data;
+  if (_h->pos + size > d.size()) d.resize(_h->pos + size);
+  memcpy(d.data() + _h->pos, buf, size);
+  _h->pos += size;
+  return size;
+}
+
+File RAMFileSystem::open(const char* path, const char* mode, bool create) {
+  std::string p = normalise(path);
+  bool write = strchr(mode, 'w') || strchr(mode, 'a') || strchr(mode, '+');
+
+  File f;
+  auto it = _files.find(p);
+  if (it == _files.end()) {
+    if (!write) {
+      // maybe it's a directory?
+      std::string prefix = p == "/" ? "/" : p + "/";
+      std::vector<std::string> children;
+      for (auto& e : _files) {
+        if (e.first.compare(0, prefix.size(), prefix) != 0) continue;
+
+        std::string rest = e.first.substr(prefix.size());
+        rest = rest.substr(0, rest.find('/'));
+        if (children.empty() || children.back() != rest) children.push_back(rest);
+      }
+      if (children.empty()) return f;   // not found
+
+      f._h = std::make_shared<File::Handle>();
+      f._h->children = children;
+    } else {
+      f._h = std::make_shared<File::Handle>();
+      f._h->data = _files[p] = std::make_shared<std::vector<uint8_t> >();
+    }
+  } else {
+    f._h = std::make_shared<File::Handle>();
+    f._h->data = it->second;
+    if (strchr(mode, 'w')) it->second->clear();   // truncate
+  }
+  f._h->path = p;
+  f._h->writable = write;
+  f._h->open = true;
+  f._h->next_child = 0;
+  f._h->fs = this;
+  f._h->pos = (f._h->data && strchr(mode, 'a')) ? f._h->data->size() : 0;
+  return f;
+}
+
+bool RAMFileSystem::exists(const char* path) const {
+  return _files.find(normalise(path)) != _files.end();
+}
+
+bool RAMFileSystem::remove(const char* path) {
+  return _files.erase(normalise(path)) > 0;
+}
+
+bool RAMFileSystem::rename(const char* from, const char* to) {
+  auto it = _files.find(normalise(from));
+  if (it == _files.end()) return false;
+
+  auto data = it->second;
+  _files.erase(it);
+  _files[normalise(to)] = data;
+  return true;
+}
+
+size_t RAMFileSystem::usedBytes() const {
+  size_t n = 0;
+  for (auto& e : _files) n += e.second->size();
+  return n;
+}
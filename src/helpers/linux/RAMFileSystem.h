@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define FILE_O_READ   "r"
+#define FILE_O_WRITE  "a+"   // same semantics as the nRF52 LittleFS: read/write, starting at end of file
+
+class RAMFileSystem;
+
+/**
+ * \brief  Handle to a file (or directory) within a RAMFileSystem. Mirrors the Arduino ESP32 'File' API,
+ *         and (like Arduino) copies of a File refer to the same open handle.
+ */
+class File : public Stream {
+  struct Handle;
+  std::shared_ptr<Handle> _h;
+
+  friend class RAMFileSystem;
+
+public:
+  File() { }
+
+  operator bool() const;
+  const char* name() const;
+  bool isDirectory() const;
+  size_t size() const;
+  size_t position() const;
+  bool seek(uint32_t pos);
+  File openNextFile();
+  void close();
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  int read(uint8_t* buf, size_t size);
+  size_t readBytes(uint8_t* buffer, size_t length) override { int n = read(buffer, length); return n < 0 ? 0 : n; }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t size) override;
+  using Print::write;
+};
+
+/**
+ * \brief  A FILESYSTEM implementation which just lives in process memory. (ie. everything is lost on exit)
+ *         Paths are absolute, eg. "/identity/_main.id", directories are created implicitly.
+ */
+class RAMFileSystem {
+  std::map<std::string, std::shared_ptr<std::vector<uint8_t> > > _files;
+
+public:
+  bool begin(bool format_if_failed = false) { return true; }
+  bool format() { _files.clear(); return true; }
+
+  File open(const char* path, const char* mode = FILE_O_READ, bool create = false);
+  bool exists(const char* path) const;
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+  bool mkdir(const char* path) { return true; }
+  bool rmdir(const char* path) { return true; }
+
+  size_t usedBytes() const;
+  size_t totalBytes() const { return 4*1024*1024; }   // nominal, nothing is actually enforced
+};
+
+extern RAMFileSystem RAMFS;   // the default instance, like SPIFFS/InternalFS on the MCU platforms
@@ -0,0 +1,85 @@
+#include "SerialTCPInterface.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+static bool setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static bool wouldBlock() {
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+
+SerialTCPInterface::SerialTCPInterface() {
+  _listen_fd = -1;
+  for (int i = 0; i < TCP_MAX_CLIENTS; i++) _fds[i] = -1;
+}
+
+SerialTCPInterface::~SerialTCPInterface() {
+  for (int i = 0; i < TCP_MAX_CLIENTS; i++) {
+    if (_fds[i] >= 0) closeClient(i);
+  }
+  if (_listen_fd >= 0) close(_listen_fd);
+}
+
+bool SerialTCPInterface::begin(int port) {
+  _listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (_listen_fd < 0) return false;
+
+  int on = 1;
+  setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(_listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 || listen(_listen_fd, TCP_MAX_CLIENTS) < 0
+      || !setNonBlocking(_listen_fd)) {
+    close(_listen_fd);
+    _listen_fd = -1;
+    return false;
+  }
+  return true;
+}
+
+// ---------- BaseTCPSerialInterface methods
+
+bool SerialTCPInterface::acceptClient(int idx) {
+  if (_listen_fd < 0) return false;
+
+  int fd = accept(_listen_fd, NULL, NULL);
+  if (fd < 0) return false;
+
+  if (idx < 0 || !setNonBlocking(fd)) {
+    close(fd);   // no free slots
+    return false;
+  }
+  int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));   // frames are small, and apps wait on replies
+  _fds[idx] = fd;
+  return true;
+}
+
+int SerialTCPInterface::readClient(int idx, uint8_t* dest, size_t max_len) {
+  ssize_t n = recv(_fds[idx], dest, max_len, 0);
+  if (n > 0) return n;
+  if (n < 0 && wouldBlock()) return 0;
+  return -1;   // closed by other end, or error
+}
+
+int SerialTCPInterface::writeClient(int idx, const uint8_t* src, size_t len) {
+  ssize_t n = send(_fds[idx], src, len, MSG_NOSIGNAL);
+  if (n >= 0) return n;
+  return wouldBlock() ? 0 : -1;
+}
+
+void SerialTCPInterface::closeClient(int idx) {
+  close(_fds[idx]);
+  _fds[idx] = -1;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <helpers/BaseTCPSerialInterface.h>
+
+/**
+ * \brief  The multi-client TCP companion interface, on POSIX sockets, for running a companion node as a Linux
+ *         process and pointing apps/scripts at it (eg. localhost:5000) for local testing
+ */
+class SerialTCPInterface : public BaseTCPSerialInterface {
+  int _listen_fd;
+  int _fds[TCP_MAX_CLIENTS];
+
+protected:
+  // BaseTCPSerialInterface methods
+  bool acceptClient(int idx) override;
+  int readClient(int idx, uint8_t* dest, size_t max_len) override;
+  int writeClient(int idx, const uint8_t* src, size_t len) override;
+  void closeClient(int idx) override;
+
+public:
+  SerialTCPInterface();
+  ~SerialTCPInterface();
+
+  /**
+   * \returns  false if can't listen on 'port'
+   */
+  bool begin(int port);
+};
@@ -0,0 +1,128 @@
+#include "SimNetwork.h"
+
+SimNetwork::SimNetwork(SimClock& clock, uint32_t seed, float capture_db) : _clock(&clock), _rng(seed), _capture_db(capture_db) {
+  resetStats();
+}
+
+void SimNetwork::resetStats() {
+  n_transmits = n_delivered = n_lost = n_below_floor = n_collisions = n_half_duplex = n_rx_full = 0;
+}
+
+int SimNetwork::addRadio(SimRadio& radio) {
+  int idx = _radios.size();
+  _radios.push_back(&radio);
+  _radio_idx[&radio] = idx;
+  _links.push_back(std::vector<SimLink>());
+  _receiving.push_back(std::vector<Reception*>());
+  radio.setMedium(this);
+  return idx;
+}
+
+void SimNetwork::setLink(int from, int to, float snr, float loss, float rssi) {
+  for (auto& l : _links[from]) {
+    if (l.to == to) {   // replace existing
+      l.snr = snr; l.loss = loss; l.rssi = rssi;
+      return;
+    }
+  }
+  SimLink l;
+  l.to = to; l.snr = snr; l.loss = loss; l.rssi = rssi;
+  _links[from].push_back(l);
+}
+
+bool SimNetwork::removeLink(int from, int to) {
+  auto& links = _links[from];
+  for (auto it = links.begin(); it != links.end(); ++it) {
+    if (it->to == to) {
+      links.erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+void SimNetwork::corrupt(Reception* r, uint32_t& counter) {
+  if (!r->corrupt) {
+    r->corrupt = true;
+    counter++;
+  }
+}
+
+void SimNetwork::transmit(SimRadio& sender, const uint8_t* bytes, int len, uint32_t airtime_millis) {
+  auto it = _radio_idx.find(&sender);
+  if (it == _radio_idx.end()) return;   // not part of this network
+  int from = it->second;
+
+  n_transmits++;
+  unsigned long now = _clock->getMillis();
+
+  // half-duplex: sender can no longer hear anything it was in the middle of receiving
+  for (auto r : _receiving[from]) {
+    corrupt(r, n_half_duplex);
+  }
+
+  for (auto& link : _links[from]) {
+    SimRadio* dest = _radios[link.to];
+    if (link.snr < dest->getMinSNR()) {
+      n_below_floor++;
+      continue;
+    }
+    if (link.loss > 0.0f && (_rng.next() % 10000) < (uint32_t)(link.loss * 10000)) {
+      n_lost++;
+      continue;
+    }
+
+    Reception* r = new Reception();
+    r->from = from;
+    r->to = link.to;
+    r->end = now + airtime_millis;
+    r->snr = link.snr;
+    r->rssi = link.rssi;
+    r->corrupt = false;
+    r->len = len;
+    memcpy(r->bytes, bytes, len);
+
+    if (!dest->isInRecvMode()) {
+      corrupt(r, n_half_duplex);
+    }
+    for (auto other : _receiving[link.to]) {   // anything else already being received by dest will overlap
+      if (r->snr >= other->snr + _capture_db) {
+        corrupt(other, n_collisions);   // new signal captures the receiver
+      } else if (other->snr >= r->snr + _capture_db) {
+        corrupt(r, n_collisions);
+      } else {
+        corrupt(other, n_collisions);
+        corrupt(r, n_collisions);
+      }
+    }
+    _receiving[link.to].push_back(r);
+    _pending.push(r);
+  }
+}
+
+void SimNetwork::update() {
+  unsigned long now = _clock->getMillis();
+  while (!_pending.empty() && (long)(now - _pending.top()->end) >= 0) {
+    Reception* r = _pending.top();
+    _pending.pop();
+
+    auto& recv = _receiving[r->to];
+    for (auto it = recv.begin(); it != recv.end(); ++it) {
+      if (*it == r) { recv.erase(it); break; }
+    }
+
+    if (!r->corrupt) {
+      if (_radios[r->to]->deliver(r->bytes, r->len, r->snr, r->rssi)) {
+        n_delivered++;
+      } else {
+        n_rx_full++;
+      }
+    }
+    delete r;
+  }
+}
+
+bool SimNetwork::isChannelBusy(const SimRadio& radio) {
+  auto it = _radio_idx.find(&radio);
+  return it != _radio_idx.end() && !_receiving[it->second].empty();
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <helpers/linux/SimRadio.h>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \brief  Virtual millisecond clock, which only moves when the simulator advances it.
+ */
+class SimClock : public mesh::MillisecondClock {
+  unsigned long _now;
+public:
+  SimClock() { _now = 0; }
+  unsigned long getMillis() override { return _now; }
+  void setMillis(unsigned long now) { _now = now; }
+};
+
+/**
+ * \brief  RTC which runs off a SimClock, starting at a given epoch time.
+ */
+class SimRTCClock : public mesh::RTCClock {
+  SimClock* _clock;
+  long _offset;
+public:
+  SimRTCClock(SimClock& clock, uint32_t epoch) : _clock(&clock) { _offset = epoch; }
+  uint32_t getCurrentTime() override { return _offset + _clock->getMillis() / 1000; }
+  void setCurrentTime(uint32_t t) override { _offset = (long)t - (long)(_clock->getMillis() / 1000); }
+};
+
+/**
+ * \brief  Seedable (xorshift) RNG, so that simulation runs are repeatable.
+ */
+class SimRNG : public mesh::RNG {
+  uint32_t _state;
+public:
+  SimRNG(uint32_t seed) { _state = seed ? seed : 1; }
+  uint32_t next() {
+    _state ^= _state << 13; _state ^= _state >> 17; _state ^= _state << 5;
+    return _state;
+  }
+  void random(uint8_t* dest, size_t sz) override {
+    while (sz-- > 0) *dest++ = next() >> 24;
+  }
+};
+
+/**
+ * \brief  Properties of the one-way link from one radio to another.
+ */
+struct SimLink {
+  int to;          // index of receiving radio
+  float snr, rssi;
+  float loss;      // probability (0..1) that a packet is lost, regardless of SNR
+};
+
+/**
+ * \brief  A SimMedium with an explicit link table. Radios which have no link to a sender can't hear it at all.
+ *         Models half-duplex (can't receive while transmitting), collisions at each receiver (with capture
+ *         of the stronger signal if it is at least 'capture_db' above the other), random per-link loss,
+ *         and the demodulation SNR floor of the receiver's spreading factor.
+ */
+class SimNetwork : public SimMedium {
+  struct Reception {
+    int from, to;
+    unsigned long end;
+    float snr, rssi;
+    bool corrupt;
+    uint8_t len;
+    uint8_t bytes[MAX_TRANS_UNIT];
+  };
+  struct EndsLater {
+    bool operator()(const Reception* a, const Reception* b) const { return a->end > b->end; }
+  };
+
+  SimClock* _clock;
+  SimRNG _rng;
+  float _capture_db;
+  std::vector<SimRadio*> _radios;
+  std::unordered_map<const SimRadio*, int> _radio_idx;
+  std::vector<std::vector<SimLink> > _links;              // by sender
+  std::vector<std::vector<Reception*> > _receiving;       // by receiver, in-flight
+  std::priority_queue<Reception*, std::vector<Reception*>, EndsLater> _pending;
+
+  void corrupt(Reception* r, uint32_t& counter);
+
+public:
+  uint32_t n_transmits, n_delivered, n_lost, n_below_floor, n_collisions, n_half_duplex, n_rx_full;
+
+  SimNetwork(SimClock& clock, uint32_t seed=1, float capture_db=6.0f);
+
+  /**
+   * \returns  the index of the newly added radio (as used by setLink())
+   */
+  int addRadio(SimRadio& radio);
+  int getNumRadios() const { return _radios.size(); }
+  SimRadio* getRadio(int idx) const { return _radios[idx]; }
+
+  /**
+   * \brief  set (or replace) the link parameters for transmissions from radio 'from' to radio 'to'
+   */
+  void setLink(int from, int to, float snr, float loss=0.0f, float rssi=-100.0f);
+  bool removeLink(int from, int to);
+  const std::vector<SimLink>& getLinksFrom(int from) const { return _links[from]; }
+
+  /**
+   * \brief  must be called after the clock is advanced, to complete any receptions which have finished
+   */
+  void update();
+
+  /**
+   * \returns  number of transmissions currently on the air
+   */
+  int getNumInFlight() const { return _pending.size(); }
+
+  void resetStats();
+
+  void transmit(SimRadio& sender, const uint8_t* bytes, int len, uint32_t airtime_millis) override;
+  bool isChannelBusy(const SimRadio& radio) override;
+};
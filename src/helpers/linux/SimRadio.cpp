@@ -0,0 +1,107 @@
+#include "SimRadio.h"
+#include <math.h>
+
+#define SIM_PREAMBLE_LEN   16   // same as the RadioLib std_init()'s
+
+SimRadio::SimRadio(mesh::MillisecondClock& ms, SimMedium* medium) : _ms(&ms), _medium(medium) {
+  _freq = 869.525f; _bw = 250; _sf = 11; _cr = 5;
+  _tx_power = 20;
+  _rx_head = _rx_count = 0;
+  _in_tx = false;
+  _tx_end = 0;
+  _last_snr = _last_rssi = 0;
+  n_recv = n_sent = n_rx_dropped = 0;
+}
+
+void SimRadio::setParams(float freq, float bw, uint8_t sf, uint8_t cr) {
+  _freq = freq; _bw = bw; _sf = sf; _cr = cr;
+}
+
+bool SimRadio::deliver(const uint8_t* bytes, int len, float snr, float rssi) {
+  if (len <= 0 || len > MAX_TRANS_UNIT) return false;
+  if (_in_tx || _rx_count >= SIM_RX_QUEUE_SIZE) {   // half-duplex, or not being polled fast enough
+    n_rx_dropped++;
+    return false;
+  }
+
+  RxFrame& f = _rx_queue[(_rx_head + _rx_count) % SIM_RX_QUEUE_SIZE];
+  memcpy(f.bytes, bytes, len);
+  f.len = len;
+  f.snr = snr;
+  f.rssi = rssi;
+  _rx_count++;
+  return true;
+}
+
+int SimRadio::recvRaw(uint8_t* bytes, int sz) {
+  if (_rx_count == 0) return 0;
+
+  RxFrame& f = _rx_queue[_rx_head];
+  _rx_head = (_rx_head + 1) % SIM_RX_QUEUE_SIZE;
+  _rx_count--;
+
+  int len = f.len;
+  if (len > sz) len = sz;
+  memcpy(bytes, f.bytes, len);
+  _last_snr = f.snr;
+  _last_rssi = f.rssi;
+  n_recv++;
+  return len;
+}
+
+uint32_t SimRadio::getEstAirtimeFor(int len_bytes) {
+  float t_sym = (float)(1 << _sf) / _bw;   // millis (bw is in kHz)
+  int de = t_sym > 16.0f ? 1 : 0;          // low data-rate optimise
+  float t_preamble = (SIM_PREAMBLE_LEN + 4.25f) * t_sym;
+
+  float n = ceilf((8.0f*len_bytes - 4.0f*_sf + 28 + 16 /* CRC */) / (4.0f*(_sf - 2*de)));
+  if (n < 0) n = 0;
+  float payload_syms = 8 + n * _cr;
+
+  return (uint32_t) (t_preamble + payload_syms * t_sym);
+}
+
+// Approximate SNR threshold per SF for successful reception (same as RadioLibWrapper)
+static float snr_threshold[] = { -7.5, -10, -12.5, -15, -17.5, -20 };
+
+float SimRadio::getMinSNR() const {
+  if (_sf < 7) return snr_threshold[0];
+  if (_sf > 12) return snr_threshold[5];
+  return snr_threshold[_sf - 7];
+}
+
+float SimRadio::packetScore(float snr, int packet_len) {
+  if (_sf < 7 || _sf > 12) return 0.0f;
+  if (snr < snr_threshold[_sf - 7]) return 0.0f;
+
+  float success_rate_based_on_snr = (snr - snr_threshold[_sf - 7]) / 10.0f;
+  float collision_penalty = 1 - (packet_len / 256.0f);
+  float score = success_rate_based_on_snr * collision_penalty;
+  return score < 0 ? 0 : (score > 1 ? 1 : score);
+}
+
+bool SimRadio::startSendRaw(const uint8_t* bytes, int len) {
+  if (_in_tx) return false;
+
+  uint32_t airtime = getEstAirtimeFor(len);
+  _in_tx = true;
+  _tx_end = _ms->getMillis() + airtime;
+  if (_medium) _medium->transmit(*this, bytes, len, airtime);
+  return true;
+}
+
+bool SimRadio::isSendComplete() {
+  if (_in_tx && (long)(_ms->getMillis() - _tx_end) >= 0) {
+    n_sent++;
+    return true;
+  }
+  return false;
+}
+
+void SimRadio::onSendFinished() {
+  _in_tx = false;
+}
+
+bool SimRadio::isReceiving() {
+  return _medium ? _medium->isChannelBusy(*this) : false;
+}
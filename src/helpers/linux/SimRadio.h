@@ -0,0 +1,89 @@
+#pragma once
+
+#include <Dispatcher.h>
+
+#ifndef SIM_RX_QUEUE_SIZE
+  #define SIM_RX_QUEUE_SIZE   8
+#endif
+
+class SimRadio;
+
+/**
+ * \brief  The shared medium (ie. the 'air') which SimRadio instances transmit into.
+ */
+class SimMedium {
+public:
+  /**
+   * \brief  called when 'sender' starts transmitting a packet. The medium is responsible for eventually
+   *         calling deliver() on any radios which should receive it.
+   */
+  virtual void transmit(SimRadio& sender, const uint8_t* bytes, int len, uint32_t airtime_millis) = 0;
+
+  /**
+   * \returns  true if 'radio' can currently hear someone else transmitting (ie. for LBT/CAD)
+   */
+  virtual bool isChannelBusy(const SimRadio& radio) { return false; }
+};
+
+/**
+ * \brief  A mesh::Radio which doesn't need any hardware. Transmits go to a SimMedium (if any), and the
+ *         medium (or a test harness) pushes received packets in with deliver().
+ *         Airtime is calculated with the standard Semtech LoRa time-on-air formula.
+ */
+class SimRadio : public mesh::Radio {
+  struct RxFrame {
+    uint8_t bytes[MAX_TRANS_UNIT];
+    uint8_t len;
+    float snr, rssi;
+  };
+
+  mesh::MillisecondClock* _ms;
+  SimMedium* _medium;
+  float _freq, _bw;
+  uint8_t _sf, _cr;
+  int8_t _tx_power;
+  RxFrame _rx_queue[SIM_RX_QUEUE_SIZE];
+  int _rx_head, _rx_count;
+  bool _in_tx;
+  unsigned long _tx_end;
+  float _last_snr, _last_rssi;
+  uint32_t n_recv, n_sent, n_rx_dropped;
+
+public:
+  SimRadio(mesh::MillisecondClock& ms, SimMedium* medium=NULL);
+
+  void setMedium(SimMedium* medium) { _medium = medium; }
+  void setParams(float freq, float bw, uint8_t sf, uint8_t cr);
+  void setTxPower(int8_t dbm) { _tx_power = dbm; }
+  int8_t getTxPower() const { return _tx_power; }
+  float getFreq() const { return _freq; }
+  uint8_t getSF() const { return _sf; }
+
+  /**
+   * \returns  the lowest SNR which can be demodulated at the current spreading factor
+   */
+  float getMinSNR() const;
+
+  /**
+   * \brief  a complete packet has been received by this radio (called by the medium, or test harness)
+   * \returns  false if the receive queue is full (ie. packet lost)
+   */
+  bool deliver(const uint8_t* bytes, int len, float snr, float rssi);
+
+  int recvRaw(uint8_t* bytes, int sz) override;
+  uint32_t getEstAirtimeFor(int len_bytes) override;
+  float packetScore(float snr, int packet_len) override;
+  bool startSendRaw(const uint8_t* bytes, int len) override;
+  bool isSendComplete() override;
+  void onSendFinished() override;
+  bool isInRecvMode() const override { return !_in_tx; }
+  bool isReceiving() override;
+
+  float getLastRSSI() const override { return _last_rssi; }
+  float getLastSNR() const override { return _last_snr; }
+
+  uint32_t getPacketsRecv() const { return n_recv; }
+  uint32_t getPacketsSent() const { return n_sent; }
+  uint32_t getPacketsDropped() const { return n_rx_dropped; }
+  void resetStats() { n_recv = n_sent = n_rx_dropped = 0; }
+};
@@ -139,21 +139,24 @@ void SerialBLEInterface::disable() {
 }
 
 size_t SerialBLEInterface::writeFrame(const uint8_t src[], size_t len) {
+  const uint8_t* parts[1] = { src };
+  return writeFrameParts(parts, &len, 1);
+}
+
+size_t SerialBLEInterface::writeFrameParts(const uint8_t* const parts[], const size_t lens[], int num_parts) {
+  size_t len = 0;
+  for (int i = 0; i < num_parts; i++) len += lens[i];
+
   if (len > MAX_FRAME_SIZE) {
     BLE_DEBUG_PRINTLN("writeFrame(), frame too big, len=%d", len);
     return 0;
   }
 
   if (_isDeviceConnected && len > 0) {
-    if (send_queue_len >= FRAME_QUEUE_SIZE) {
+    if (!send_queue.push(parts, lens, num_parts)) {
       BLE_DEBUG_PRINTLN("writeFrame(), send_queue is full!");
       return 0;
     }
-
-    send_queue[send_queue_len].len = len;  // add to send queue
-    memcpy(send_queue[send_queue_len].buf, src, len);
-    send_queue_len++;
-
     return len;
   }
   return 0;
@@ -166,17 +169,16 @@ bool SerialBLEInterface::isWriteBusy() const {
 }
 
 size_t SerialBLEInterface::checkRecvFrame(uint8_t dest[]) {
-  if (send_queue_len > 0   // first, check send queue
-    && millis() >= _last_write + BLE_WRITE_MIN_INTERVAL    // space the writes apart
+  const uint8_t* frame;
+  size_t len;
+  if (millis() >= _last_write + BLE_WRITE_MIN_INTERVAL    // space the writes apart
+    && (frame = send_queue.peek(len)) != NULL   // first, check send queue
   ) {
     _last_write = millis();
-    bleuart.write(send_queue[0].buf, send_queue[0].len);
-    BLE_DEBUG_PRINTLN("writeBytes: sz=%d, hdr=%d", (uint32_t)send_queue[0].len, (uint32_t) send_queue[0].buf[0]);
+    bleuart.write(frame, len);   // straight from the queue
+    BLE_DEBUG_PRINTLN("writeBytes: sz=%d, hdr=%d", (uint32_t)len, (uint32_t) frame[0]);
 
-    send_queue_len--;
-    for (int i = 0; i < send_queue_len; i++) {   // delete top item from queue
-      send_queue[i] = send_queue[i + 1];
-    }
+    send_queue.pop();
   } else {
     int len = bleuart.available();
     if (len > 0) {
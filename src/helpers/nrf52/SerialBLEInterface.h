@@ -13,16 +13,9 @@ class SerialBLEInterface : public BaseSerialInterface {
   bool _isDeviceConnected;
   unsigned long _last_write;
 
-  struct Frame {
-    uint8_t len;
-    uint8_t buf[MAX_FRAME_SIZE];
-  };
+  FrameQueue<SERIAL_SEND_QUEUE_BYTES> send_queue;
 
-  #define FRAME_QUEUE_SIZE  4
-  int send_queue_len;
-  Frame send_queue[FRAME_QUEUE_SIZE];
-
-  void clearBuffers() { send_queue_len = 0; }
+  void clearBuffers() { send_queue.clear(); }
   static void onConnect(uint16_t connection_handle);
   static void onDisconnect(uint16_t connection_handle, uint8_t reason);
   static void onSecured(uint16_t connection_handle);
@@ -32,7 +25,6 @@ public:
     _isEnabled = false;
     _isDeviceConnected = false;
     _last_write = 0;
-    send_queue_len = 0;
   }
 
   void startAdv();
@@ -48,7 +40,9 @@ public:
 
   bool isWriteBusy() const override;
   size_t writeFrame(const uint8_t src[], size_t len) override;
+  size_t writeFrameParts(const uint8_t* const parts[], const size_t lens[], int num_parts) override;
   size_t checkRecvFrame(uint8_t dest[]) override;
+  bool getSendQueueStats(FrameQueueStats& stats) const override { send_queue.getStats(stats); return true; }
 };
 
 #if BLE_DEBUG_LOGGING && ARDUINO
@@ -0,0 +1,43 @@
+#include <Arduino.h>
+#include "target.h"
+
+#ifndef LORA_CR
+  #define LORA_CR      5
+#endif
+#ifndef LORA_TX_POWER
+  #define LORA_TX_POWER  20
+#endif
+
+LinuxBoard board;
+
+static LinuxMillis radio_clock;
+SimRadio radio_driver(radio_clock);   // NOTE: no SimMedium, so transmits just go nowhere
+
+LinuxRTCClock rtc_clock;
+SensorManager sensors;
+
+bool radio_init() {
+  radio_set_params(LORA_FREQ, LORA_BW, LORA_SF, LORA_CR);
+  radio_set_tx_power(LORA_TX_POWER);
+  return true;  // success
+}
+
+uint32_t radio_get_rng_seed() {
+  LinuxRNG rng;
+  uint32_t seed;
+  rng.random((uint8_t *) &seed, sizeof(seed));
+  return seed;
+}
+
+void radio_set_params(float freq, float bw, uint8_t sf, uint8_t cr) {
+  radio_driver.setParams(freq, bw, sf, cr);
+}
+
+void radio_set_tx_power(uint8_t dbm) {
+  radio_driver.setTxPower(dbm);
+}
+
+mesh::LocalIdentity radio_new_identity() {
+  LinuxRNG rng;
+  return mesh::LocalIdentity(&rng);  // create new random identity
+}
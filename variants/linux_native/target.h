@@ -0,0 +1,18 @@
+#pragma once
+
+#include <helpers/linux/LinuxBoard.h>
+#include <helpers/linux/LinuxHelpers.h>
+#include <helpers/linux/SimRadio.h>
+#include <helpers/linux/RAMFileSystem.h>
+#include <helpers/SensorManager.h>
+
+extern LinuxBoard board;
+extern SimRadio radio_driver;
+extern LinuxRTCClock rtc_clock;
+extern SensorManager sensors;
+
+bool radio_init();
+uint32_t radio_get_rng_seed();
+void radio_set_params(float freq, float bw, uint8_t sf, uint8_t cr);
+void radio_set_tx_power(uint8_t dbm);
+mesh::LocalIdentity radio_new_identity();
@@ -0,0 +1,41 @@
+#include <Arduino.h>
+#include "target.h"
+
+#ifndef LORA_CR
+  #define LORA_CR      5
+#endif
+#ifndef LORA_TX_POWER
+  #define LORA_TX_POWER  20
+#endif
+
+LinuxBoard board;
+SimRadioSelector radio_driver;
+SensorManager sensors;   // NOTE: shared by all nodes
+
+void sim_select_node(SimRadio* radio, mesh::RNG* rng) {
+  radio_driver.select(radio, rng);
+}
+
+bool radio_init() {
+  radio_set_params(LORA_FREQ, LORA_BW, LORA_SF, LORA_CR);
+  radio_set_tx_power(LORA_TX_POWER);
+  return true;  // success
+}
+
+uint32_t radio_get_rng_seed() {
+  uint32_t seed;
+  radio_driver.currentRNG()->random((uint8_t *) &seed, sizeof(seed));
+  return seed;
+}
+
+void radio_set_params(float freq, float bw, uint8_t sf, uint8_t cr) {
+  radio_driver.current()->setParams(freq, bw, sf, cr);
+}
+
+void radio_set_tx_power(uint8_t dbm) {
+  radio_driver.current()->setTxPower(dbm);
+}
+
+mesh::LocalIdentity radio_new_identity() {
+  return mesh::LocalIdentity(radio_driver.currentRNG());  // deterministic, from the node's seeded RNG
+}
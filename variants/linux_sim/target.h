@@ -0,0 +1,42 @@
+#pragma once
+
+#include <helpers/linux/LinuxBoard.h>
+#include <helpers/linux/SimNetwork.h>
+#include <helpers/linux/RAMFileSystem.h>
+#include <helpers/SensorManager.h>
+
+/**
+ * \brief  In the simulator many nodes share the one process, so the example code's references to the
+ *         'radio_driver' global (and radio_set_params() etc.) are redirected to the radio/RNG of whichever
+ *         node the simulator is currently running. See sim_select_node().
+ */
+class SimRadioSelector {
+  SimRadio* _radio;
+  mesh::RNG* _rng;
+
+public:
+  SimRadioSelector() : _radio(NULL), _rng(NULL) { }
+
+  void select(SimRadio* radio, mesh::RNG* rng) { _radio = radio; _rng = rng; }
+  SimRadio* current() const { return _radio; }
+  mesh::RNG* currentRNG() const { return _rng; }
+
+  float getLastRSSI() const { return _radio->getLastRSSI(); }
+  float getLastSNR() const { return _radio->getLastSNR(); }
+  int getNoiseFloor() const { return _radio->getNoiseFloor(); }
+  uint32_t getPacketsRecv() const { return _radio->getPacketsRecv(); }
+  uint32_t getPacketsSent() const { return _radio->getPacketsSent(); }
+  void resetStats() { _radio->resetStats(); }
+};
+
+extern LinuxBoard board;
+extern SimRadioSelector radio_driver;
+extern SensorManager sensors;
+
+void sim_select_node(SimRadio* radio, mesh::RNG* rng);
+
+bool radio_init();
+uint32_t radio_get_rng_seed();
+void radio_set_params(float freq, float bw, uint8_t sf, uint8_t cr);
+void radio_set_tx_power(uint8_t dbm);
+mesh::LocalIdentity radio_new_identity();